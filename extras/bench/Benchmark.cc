@@ -0,0 +1,618 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+///
+/// Microbenchmarks for the controller and preset hot paths, run on a Linux
+/// host against the simulated backend and against FastLEDController and
+/// NeoPixelController with their libraries stubbed out by extras/host.  The
+/// stubs do not transmit, so results are the CPU cost of each operation.
+/// Each result also counts the heap allocations made while it ran, so that
+/// allocations on the render path show up, and reports the heap memory held
+/// by the controller it ran against.
+///
+/// Build from the repository root, as a single command:
+///
+///     g++ -O2 -std=c++11 -DLIGHTSHOW_SIMULATED_ENABLE=1 -Iextras/host -Isrc
+///         extras/bench/Benchmark.cc src/*.cc extras/host/*.cc -o benchmark
+///
+/// Add -DLIGHTSHOW_NEOPIXEL_ZEROCOPY=1 to measure the zero-copy NeoPixel mode.
+///
+/// Usage: benchmark [--json] [--min-ms N] [--max-pixels N]
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Compositor.h"
+#include "DoubleBufferedController.h"
+#include "FastLEDController.h"
+#include "HeapCounter.h"
+#include "Lerp.h"
+#include "MultiStripController.h"
+#include "NeoPixelController.h"
+#include "PulseColorPreset.h"
+#include "SimulatedController.h"
+#include "StaticController.h"
+#include "Transport.h"
+#include "VirtualClock.h"
+
+namespace {
+
+/// a backend that can be benchmarked
+struct Backend {
+  /// the name reported in the results
+  const char *name;
+
+  /// the largest strip the backend supports
+  uint32_t max_pixels;
+
+  /// create a controller for a strip of the given length
+  std::function<std::shared_ptr<LightShow::Controller>(uint32_t)> create;
+};
+
+/// the result of timing one operation
+struct Result {
+  /// the backend that was measured
+  std::string backend;
+
+  /// the operation that was measured
+  std::string operation;
+
+  /// the number of pixels in the strip
+  uint32_t pixels;
+
+  /// the number of times the operation was run
+  uint64_t iterations;
+
+  /// the average time taken by one run of the operation
+  double ns_per_frame;
+
+  /// the number of heap allocations made while the operation was running
+  uint64_t allocations;
+
+  /// the heap memory held by the controller, including any strip library's
+  /// own buffer
+  uint64_t heap_bytes;
+};
+
+/// how long each pixel takes on the simulated wire, in nanoseconds: 100 times
+/// faster than WS2812, so that runs stay short
+constexpr uint32_t kWirePixelNs = 300;
+
+/// a double-buffered controller and the transport that it sends through
+struct WiredController {
+  /**
+   * Create the controller
+   * @param pixels the number of pixels in the strip
+   * @param async true to send frames in the background
+   */
+  WiredController(uint32_t pixels, bool async)
+      : transport(kWirePixelNs, async), controller(pixels, &transport) {}
+
+  /// sends frames from a second thread
+  LightShow::ThreadTransport transport;
+
+  /// renders into one buffer while the other is sent
+  LightShow::DoubleBufferedController controller;
+};
+
+/// the strip lengths to measure
+const uint32_t kSizes[] = {30, 100, 300, 1000, 3000, 10000, 30000, 100000};
+
+/**
+ * run an operation repeatedly until at least min_ms of real time has passed
+ * @param min_ms the minimum time to spend measuring
+ * @param op the operation to measure, called with the iteration number
+ * @param iterations set to the number of times op was called
+ * @return the average time taken by one call, in nanoseconds
+ */
+double Measure(uint32_t min_ms, const std::function<void(uint64_t)> &op,
+               uint64_t *iterations) {
+  using Clock = std::chrono::steady_clock;
+  const auto min_time = std::chrono::milliseconds(min_ms);
+  uint64_t count = 0;
+  uint64_t batch = 1;
+  const auto start = Clock::now();
+  auto elapsed = Clock::duration::zero();
+  while (elapsed < min_time) {
+    for (uint64_t i = 0; i < batch; i++) {
+      op(count + i);
+    }
+    count += batch;
+    batch *= 2;
+    elapsed = Clock::now() - start;
+  }
+  *iterations = count;
+  return static_cast<double>(
+             std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                 .count()) /
+         static_cast<double>(count);
+}
+
+/**
+ * interpolate a buffer towards a color with a float product per channel, as
+ * fades did before the fixed-point kernel, kept as a baseline for it
+ * @param out the buffer to write, len bytes long
+ * @param from the values at scale 0, len bytes long
+ * @param len the number of bytes to interpolate
+ * @param color the target pixel, 3 bytes
+ * @param scale the progress towards color, 0.0 to 1.0
+ */
+void LerpToColorFloat(uint8_t *out, const uint8_t *from, size_t len,
+                      const uint8_t *color, float scale) {
+  for (size_t i = 0; i < len; i++) {
+    const int delta = color[i % 3] - from[i];
+    out[i] = static_cast<uint8_t>(
+        from[i] + static_cast<int>(static_cast<float>(delta) * scale));
+  }
+}
+
+/**
+ * measure the fade interpolation kernel against its float baseline
+ * @param pixels the number of pixels in the strip
+ * @param min_ms the minimum time to spend on each operation
+ * @param results the list to append results to
+ */
+void RunKernels(uint32_t pixels, uint32_t min_ms,
+                std::vector<Result> *results) {
+  auto add = [&](const char *operation,
+                 const std::function<void(uint64_t)> &op) {
+    Result result;
+    result.backend = "kernel";
+    result.operation = operation;
+    result.pixels = pixels;
+    result.heap_bytes = 0;
+    const uint64_t allocations = LightShow::GetHeapAllocations();
+    result.ns_per_frame = Measure(min_ms, op, &result.iterations);
+    result.allocations = LightShow::GetHeapAllocations() - allocations;
+    results->push_back(result);
+  };
+
+  const size_t len = pixels * sizeof(LightShow::Pixel);
+  std::vector<uint8_t> from(len);
+  std::vector<uint8_t> out(len);
+  for (size_t i = 0; i < len; i++) {
+    from[i] = static_cast<uint8_t>(i * 7);
+  }
+  const uint8_t color[3] = {0xFF, 0x80, 0x00};
+
+  // one fade frame, computed with a float product per channel
+  add("lerp_float", [&](uint64_t n) {
+    LerpToColorFloat(out.data(), from.data(), len, color,
+                     static_cast<float>(n % LightShow::kLerpOne) /
+                         static_cast<float>(LightShow::kLerpOne));
+  });
+
+  // the same frame, computed by the fixed-point kernel that fades use
+  add("lerp_fixed", [&](uint64_t n) {
+    LightShow::LerpToColor(out.data(), from.data(), len, color,
+                           sizeof(LightShow::Pixel),
+                           static_cast<uint16_t>(n % LightShow::kLerpOne));
+  });
+}
+
+/**
+ * measure rendering that takes as long as the wire, sending each frame
+ * either in the foreground or in the background
+ * @param pixels the number of pixels in the strip
+ * @param min_ms the minimum time to spend on each operation
+ * @param results the list to append results to
+ */
+void RunWire(uint32_t pixels, uint32_t min_ms, std::vector<Result> *results) {
+  using Clock = std::chrono::steady_clock;
+  const auto render = std::chrono::nanoseconds(
+      static_cast<uint64_t>(kWirePixelNs) * pixels);
+  for (const bool async : {false, true}) {
+    const uint64_t heap_bytes = LightShow::GetHeapBytes();
+    WiredController wired(pixels, async);
+    Result result;
+    result.backend = async ? "wire_async" : "wire_sync";
+    result.operation = "render_update";
+    result.pixels = pixels;
+    result.heap_bytes = LightShow::GetHeapBytes() - heap_bytes;
+    const uint64_t allocations = LightShow::GetHeapAllocations();
+    // stands in for a preset that spends as long drawing each frame as the
+    // wire spends sending it; sent in the background, the two overlap
+    result.ns_per_frame = Measure(
+        min_ms,
+        [&](uint64_t n) {
+          const auto until = Clock::now() + render;
+          wired.controller.SetLEDs(static_cast<uint8_t>(n), 0x20, 0x40);
+          while (Clock::now() < until) {
+          }
+          wired.controller.Update();
+        },
+        &result.iterations);
+    result.allocations = LightShow::GetHeapAllocations() - allocations;
+    results->push_back(result);
+  }
+}
+
+/**
+ * measure every operation on one backend at one strip length
+ * @param backend the backend to measure
+ * @param pixels the number of pixels in the strip
+ * @param min_ms the minimum time to spend on each operation
+ * @param results the list to append results to
+ */
+void RunBackend(const Backend &backend, uint32_t pixels, uint32_t min_ms,
+                std::vector<Result> *results) {
+  const uint64_t heap_bytes = LightShow::GetHeapBytes();
+  auto controller = backend.create(pixels);
+  const uint64_t held = LightShow::GetHeapBytes() - heap_bytes;
+  auto add = [&](const char *operation,
+                 const std::function<void(uint64_t)> &op) {
+    Result result;
+    result.backend = backend.name;
+    result.operation = operation;
+    result.pixels = pixels;
+    result.heap_bytes = held;
+    const uint64_t allocations = LightShow::GetHeapAllocations();
+    result.ns_per_frame = Measure(min_ms, op, &result.iterations);
+    result.allocations = LightShow::GetHeapAllocations() - allocations;
+    results->push_back(result);
+  };
+
+  // write every pixel through the per-pixel virtual call
+  add("set_led", [&](uint64_t n) {
+    const auto v = static_cast<uint8_t>(n);
+    for (uint32_t i = 0; i < pixels; i++) {
+      controller->SetLED(i, v, static_cast<uint8_t>(i), 0x40);
+    }
+  });
+
+  // write the same pixels as a whole frame, in one virtual call; the frame is
+  // drawn once, up front, so that only the copy is timed
+  std::vector<LightShow::Pixel> frame(pixels);
+  for (uint32_t i = 0; i < pixels; i++) {
+    frame[i] = {0x80, static_cast<uint8_t>(i), 0x40};
+  }
+  add("blit", [&](uint64_t) { controller->Blit(0, frame.data(), pixels); });
+
+  // write every pixel with the same color, as one run
+  add("set_range", [&](uint64_t n) {
+    controller->SetRange(0, pixels, static_cast<uint8_t>(n), 0x20, 0x40);
+  });
+
+  // read every pixel back, as one run
+  add("get_frame", [&](uint64_t) {
+    controller->GetFrame(0, frame.data(), pixels);
+  });
+
+  // write every pixel with the same color
+  add("set_leds", [&](uint64_t n) {
+    controller->SetLEDs(static_cast<uint8_t>(n), 0x20, 0x40);
+  });
+
+  // push a frame that has not changed since the last push
+  controller->Update();
+  add("update_static", [&](uint64_t) { controller->Update(); });
+
+  // change every pixel, then push the frame
+  add("set_leds_update", [&](uint64_t n) {
+    controller->SetLEDs(static_cast<uint8_t>(n), 0x20, 0x40);
+    controller->Update();
+  });
+
+  // the same, with gamma and brightness applied on the way to the wire
+  LightShow::OutputStage stage;
+  stage.SetGamma(LightShow::Curve::Gamma22);
+  stage.SetBrightness(0xC0);
+  controller->SetOutputStage(&stage);
+  add("set_leds_update_lut", [&](uint64_t n) {
+    controller->SetLEDs(static_cast<uint8_t>(n), 0x20, 0x40);
+    controller->Update();
+  });
+  controller->SetOutputStage(nullptr);
+
+  // the same, scaled down to fit a power budget on the way to the wire, by
+  // the controllers that can limit their strip
+  if (controller->SetPowerBudget(pixels) == LightShow::NoError) {
+    add("set_leds_update_power", [&](uint64_t n) {
+      controller->SetLEDs(static_cast<uint8_t>(n) | 0x80, 0x20, 0x40);
+      controller->Update();
+    });
+    controller->SetPowerBudget(0);
+  }
+
+  // render and push one frame of a long fade
+  controller->SetLEDs(0x00, 0x80, 0xFF);
+  controller->BeginFade(0xFFFFFFFF, 0xFF, 0x80, 0x00);
+  add("fade_frame", [&](uint64_t) { controller->Loop(); });
+
+  // the same, heading to a different color on every pixel
+  for (uint32_t i = 0; i < pixels; i++) {
+    frame[i] = {static_cast<uint8_t>(i), 0x80, static_cast<uint8_t>(~i)};
+  }
+  controller->BeginCrossFade(0xFFFFFFFF, frame.data(), pixels);
+  add("crossfade_frame", [&](uint64_t) { controller->Loop(); });
+
+  // the same, eased, which adds one table lookup per frame
+  controller->SetFadeCurve(LightShow::Curve::CubicInOut);
+  controller->BeginCrossFade(0xFFFFFFFF, frame.data(), pixels);
+  add("crossfade_frame_eased", [&](uint64_t) { controller->Loop(); });
+  controller->SetFadeCurve(LightShow::Curve::Linear);
+
+  // one loop of a preset that changes the strip on every call
+  LightShow::PulseColorPreset preset(controller, 0xFF, 0x80, 0x40, 1, 255);
+  add("preset_loop", [&](uint64_t) { preset.Loop(); });
+
+  // blend four changing layers into the frame, then push it
+  LightShow::Compositor compositor(controller, pixels);
+  std::shared_ptr<LightShow::Layer> layers[] = {
+      compositor.AddLayer(LightShow::BlendMode::Normal),
+      compositor.AddLayer(LightShow::BlendMode::Add, 0x80),
+      compositor.AddLayer(LightShow::BlendMode::Multiply),
+      compositor.AddLayer(LightShow::BlendMode::Alpha, 0xC0)};
+  add("composite4", [&](uint64_t n) {
+    for (auto &layer : layers) {
+      layer->SetLEDs(static_cast<uint8_t>(n), 0x80, 0x40);
+      layer->Update();
+    }
+    compositor.Update();
+  });
+}
+
+/**
+ * measure the same work through the virtual interface and through the
+ * concrete type of a controller, whose methods can then be inlined
+ * @tparam ControllerT the concrete type of the controller
+ * @param backend the name to report the results under
+ * @param pixels the number of pixels in the strip
+ * @param create makes the controller
+ * @param min_ms the minimum time to spend on each operation
+ * @param results the list to append results to
+ */
+template <class ControllerT>
+void RunDispatch(const char *backend, uint32_t pixels,
+                 const std::function<std::shared_ptr<ControllerT>()> &create,
+                 uint32_t min_ms, std::vector<Result> *results) {
+  const uint64_t heap_bytes = LightShow::GetHeapBytes();
+  std::shared_ptr<ControllerT> concrete = create();
+  const uint64_t held = LightShow::GetHeapBytes() - heap_bytes;
+  std::shared_ptr<LightShow::Controller> controller = concrete;
+  auto add = [&](const char *operation,
+                 const std::function<void(uint64_t)> &op) {
+    Result result;
+    result.backend = backend;
+    result.operation = operation;
+    result.pixels = pixels;
+    result.heap_bytes = held;
+    const uint64_t allocations = LightShow::GetHeapAllocations();
+    result.ns_per_frame = Measure(min_ms, op, &result.iterations);
+    result.allocations = LightShow::GetHeapAllocations() - allocations;
+    results->push_back(result);
+  };
+
+  // write every pixel through the per-pixel virtual call
+  add("set_led", [&](uint64_t n) {
+    const auto v = static_cast<uint8_t>(n);
+    for (uint32_t i = 0; i < pixels; i++) {
+      controller->SetLED(i, v, static_cast<uint8_t>(i), 0x40);
+    }
+  });
+
+  // the same, called on the concrete type
+  add("set_led_static", [&](uint64_t n) {
+    const auto v = static_cast<uint8_t>(n);
+    for (uint32_t i = 0; i < pixels; i++) {
+      concrete->SetLED(i, v, static_cast<uint8_t>(i), 0x40);
+    }
+  });
+
+  // one loop of a preset that changes the strip on every call
+  LightShow::PulseColorPreset preset(controller, 0xFF, 0x80, 0x40, 1, 255);
+  add("preset_loop", [&](uint64_t) { preset.Loop(); });
+
+  // the same preset, templated on the concrete type
+  LightShow::BasicPulseColorPreset<ControllerT> static_preset(
+      concrete, 0xFF, 0x80, 0x40, 1, 255);
+  add("preset_loop_static", [&](uint64_t) { static_preset.Loop(); });
+}
+
+/**
+ * measure virtual against static dispatch on every controller that can be
+ * named as a concrete type
+ * @tparam N the number of pixels in the strip, which a StaticController
+ * needs at compile time
+ * @param min_ms the minimum time to spend on each operation
+ * @param results the list to append results to
+ */
+template <uint32_t N>
+void RunStatic(uint32_t min_ms, std::vector<Result> *results) {
+  typedef LightShow::StaticController<N, LightShow::NullBackend> Static;
+  RunDispatch<Static>(
+      "static", N, [] { return std::make_shared<Static>(); }, min_ms,
+      results);
+#if LIGHTSHOW_FASTLED_ENABLE == 1
+  RunDispatch<LightShow::FastLEDController>(
+      "fastled_dispatch", N,
+      [] { return std::make_shared<LightShow::FastLEDController>(N); },
+      min_ms, results);
+#endif
+#if LIGHTSHOW_NEOPIXEL_ENABLE == 1
+  RunDispatch<LightShow::NeoPixelController>(
+      "neopixel_dispatch", N,
+      [] { return std::make_shared<LightShow::NeoPixelController>(N); },
+      min_ms, results);
+#endif
+}
+
+/**
+ * print results as CSV
+ * @param results the results to print
+ */
+void PrintCSV(const std::vector<Result> &results) {
+  printf(
+      "backend,operation,pixels,iterations,ns_per_frame,ns_per_pixel,"
+      "frames_per_second,allocations,heap_bytes\n");
+  for (const auto &r : results) {
+    printf("%s,%s,%u,%llu,%.1f,%.3f,%.1f,%llu,%llu\n", r.backend.c_str(),
+           r.operation.c_str(), r.pixels,
+           static_cast<unsigned long long>(r.iterations),  // NOLINT
+           r.ns_per_frame, r.ns_per_frame / r.pixels, 1e9 / r.ns_per_frame,
+           static_cast<unsigned long long>(r.allocations),  // NOLINT
+           static_cast<unsigned long long>(r.heap_bytes));  // NOLINT
+  }
+}
+
+/**
+ * print results as JSON
+ * @param results the results to print
+ */
+void PrintJSON(const std::vector<Result> &results) {
+  printf("[\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto &r = results[i];
+    printf(
+        "  {\"backend\": \"%s\", \"operation\": \"%s\", \"pixels\": %u, "
+        "\"iterations\": %llu, \"ns_per_frame\": %.1f, "
+        "\"ns_per_pixel\": %.3f, \"frames_per_second\": %.1f, "
+        "\"allocations\": %llu, \"heap_bytes\": %llu}%s\n",
+        r.backend.c_str(), r.operation.c_str(), r.pixels,
+        static_cast<unsigned long long>(r.iterations),  // NOLINT
+        r.ns_per_frame, r.ns_per_frame / r.pixels, 1e9 / r.ns_per_frame,
+        static_cast<unsigned long long>(r.allocations),  // NOLINT
+        static_cast<unsigned long long>(r.heap_bytes),   // NOLINT
+        (i + 1 < results.size()) ? "," : "");
+  }
+  printf("]\n");
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  bool json = false;
+  uint32_t min_ms = 50;
+  uint32_t max_pixels = 100000;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+      min_ms = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+    } else if (strcmp(argv[i], "--max-pixels") == 0 && i + 1 < argc) {
+      max_pixels = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+    } else {
+      fprintf(stderr, "usage: %s [--json] [--min-ms N] [--max-pixels N]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+
+  // fades follow millis(), so give them a clock that moves on every read
+  LightShow::VirtualClock clock(0, 1);
+  LightShow::VirtualClock::Install(&clock);
+
+  std::vector<Backend> backends;
+  backends.push_back({"simulated", 0xFFFFFFFF, [](uint32_t n) {
+                        auto c =
+                            std::make_shared<LightShow::SimulatedController>(n);
+                        c->SetCapture(false);
+                        return std::shared_ptr<LightShow::Controller>(c);
+                      }});
+  // the frame split across four strips that push nowhere, measuring the cost
+  // of the fan-out itself
+  backends.push_back({"multistrip4", 0xFFFFFFFF, [](uint32_t n) {
+                        auto c =
+                            std::make_shared<LightShow::MultiStripController>(
+                                n);
+                        for (uint32_t i = 0; i < 4; i++) {
+                          c->AddStrip<LightShow::NullBackend>(
+                              (n + 3 - i) / 4);
+                        }
+                        return std::shared_ptr<LightShow::Controller>(c);
+                      }});
+  // a double-buffered frame sent by a thread standing in for DMA; wire_sync
+  // blocks until each frame is sent, wire_async sends it in the background.
+  // These operations render far faster than the wire, so both are bound by
+  // the wire; RunWire() below renders for as long as the wire takes
+  for (const bool async : {false, true}) {
+    backends.push_back(
+        {async ? "wire_async" : "wire_sync", 0xFFFFFFFF, [async](uint32_t n) {
+           auto wired = std::make_shared<WiredController>(n, async);
+           return std::shared_ptr<LightShow::Controller>(wired,
+                                                         &wired->controller);
+         }});
+  }
+#if LIGHTSHOW_FASTLED_ENABLE == 1
+  backends.push_back({"fastled", 0xFFFFFFFF, [](uint32_t n) {
+                        return std::shared_ptr<LightShow::Controller>(
+                            std::make_shared<LightShow::FastLEDController>(n));
+                      }});
+#endif
+#if LIGHTSHOW_NEOPIXEL_ENABLE == 1
+#if LIGHTSHOW_NEOPIXEL_ZEROCOPY == 1
+  const char *neopixel_name = "neopixel_zerocopy";
+#else
+  const char *neopixel_name = "neopixel";
+#endif
+  backends.push_back({neopixel_name, 0xFFFF, [](uint32_t n) {
+                        return std::shared_ptr<LightShow::Controller>(
+                            std::make_shared<LightShow::NeoPixelController>(
+                                static_cast<uint16_t>(n)));
+                      }});
+#endif
+
+  std::vector<Result> results;
+  for (auto pixels : kSizes) {
+    if (pixels <= max_pixels) {
+      RunKernels(pixels, min_ms, &results);
+    }
+  }
+  for (const auto &backend : backends) {
+    for (auto pixels : kSizes) {
+      if (pixels <= max_pixels && pixels <= backend.max_pixels) {
+        RunBackend(backend, pixels, min_ms, &results);
+      }
+    }
+  }
+
+  for (auto pixels : kSizes) {
+    if (pixels <= max_pixels && pixels <= 3000) {
+      RunWire(pixels, min_ms, &results);
+    }
+  }
+
+  // static dispatch needs the strip length at compile time
+  if (max_pixels >= 30) {
+    RunStatic<30>(min_ms, &results);
+  }
+  if (max_pixels >= 300) {
+    RunStatic<300>(min_ms, &results);
+  }
+
+  if (json) {
+    PrintJSON(results);
+  } else {
+    PrintCSV(results);
+  }
+  return 0;
+}
@@ -0,0 +1,209 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+///
+/// A minimal stand-in for the Adafruit NeoPixel library, so that
+/// NeoPixelController can be built and measured on a Linux host.  Pixels are
+/// stored in the same native order as the real library, but nothing is
+/// transmitted.
+
+#ifndef LIGHTSHOW_HOST_ADAFRUIT_NEOPIXEL_H
+#define LIGHTSHOW_HOST_ADAFRUIT_NEOPIXEL_H
+
+#include <Arduino.h>
+
+#include <vector>
+
+/// the NEO_* constants describing a strip's color order and speed
+typedef uint16_t neoPixelType;
+
+// color orders, as offsets of white, red, green and blue within a pixel
+#define NEO_RGB ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_RBG ((0 << 6) | (0 << 4) | (2 << 2) | (1))
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_GBR ((2 << 6) | (2 << 4) | (0 << 2) | (1))
+#define NEO_BRG ((1 << 6) | (1 << 4) | (2 << 2) | (0))
+#define NEO_BGR ((2 << 6) | (2 << 4) | (1 << 2) | (0))
+#define NEO_RGBW ((3 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_GRBW ((3 << 6) | (1 << 4) | (0 << 2) | (2))
+
+// data rates
+#define NEO_KHZ800 0x0000
+#define NEO_KHZ400 0x0100
+
+/**
+ * a strip of NeoPixels
+ */
+class Adafruit_NeoPixel {
+ public:
+  /**
+   * Create a strip
+   * @param n the number of pixels in the strip
+   * @param pin the pin that drives the strip
+   * @param type the NEO_* color order and speed of the strip
+   */
+  Adafruit_NeoPixel(uint16_t n, int16_t pin = 6,
+                    neoPixelType type = NEO_GRB + NEO_KHZ800)
+      : pin_(pin) {
+    this->updateType(type);
+    this->updateLength(n);
+  }
+
+  /// Create an empty strip, to be sized with updateLength() and updateType()
+  Adafruit_NeoPixel() : Adafruit_NeoPixel(0, -1) {}
+
+  /**
+   * Change the number of pixels in the strip, clearing every pixel
+   * @param n the number of pixels in the strip
+   */
+  void updateLength(uint16_t n) {
+    this->num_ = n;
+    this->pixels_.assign(n * this->bpp_, 0);
+  }
+
+  /**
+   * Change the color order and speed of the strip
+   * @param type the NEO_* color order and speed of the strip
+   */
+  void updateType(neoPixelType type) {
+    this->w_offset_ = (type >> 6) & 0x03;
+    this->r_offset_ = (type >> 4) & 0x03;
+    this->g_offset_ = (type >> 2) & 0x03;
+    this->b_offset_ = type & 0x03;
+    this->bpp_ = (this->w_offset_ == this->r_offset_) ? 3 : 4;
+    this->pixels_.assign(this->num_ * this->bpp_, 0);
+  }
+
+  /**
+   * Change the pin that drives the strip
+   * @param pin the pin that drives the strip
+   */
+  void setPin(int16_t pin) { this->pin_ = pin; }
+
+  /// Prepare the data pin for output
+  void begin() {}
+
+  /// Push the pixels to the strip
+  void show() { this->shows_++; }
+
+  /**
+   * Set a pixel to a color
+   * @param n the index of the pixel
+   * @param r red 0-255
+   * @param g green 0-255
+   * @param b blue 0-255
+   */
+  void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+    if (n >= this->num_) {
+      return;
+    }
+    uint8_t *p = &this->pixels_[n * this->bpp_];
+    if (this->bpp_ == 4) {
+      p[this->w_offset_] = 0;
+    }
+    p[this->r_offset_] = r;
+    p[this->g_offset_] = g;
+    p[this->b_offset_] = b;
+  }
+
+  /**
+   * Set a pixel to a color
+   * @param n the index of the pixel
+   * @param r red 0-255
+   * @param g green 0-255
+   * @param b blue 0-255
+   * @param w white 0-255
+   */
+  void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    if (n >= this->num_) {
+      return;
+    }
+    uint8_t *p = &this->pixels_[n * this->bpp_];
+    if (this->bpp_ == 4) {
+      p[this->w_offset_] = w;
+    }
+    p[this->r_offset_] = r;
+    p[this->g_offset_] = g;
+    p[this->b_offset_] = b;
+  }
+
+  /**
+   * Set a pixel to a color
+   * @param n the index of the pixel
+   * @param c the color in 0xWWRRGGBB format
+   */
+  void setPixelColor(uint16_t n, uint32_t c) {
+    this->setPixelColor(n, static_cast<uint8_t>(c >> 16),
+                        static_cast<uint8_t>(c >> 8), static_cast<uint8_t>(c),
+                        static_cast<uint8_t>(c >> 24));
+  }
+
+  /**
+   * return the pixel buffer, in the strip's native color order
+   * @return the pixel buffer
+   */
+  uint8_t *getPixels() { return this->pixels_.data(); }
+
+  /**
+   * return the number of pixels in the strip
+   * @return the number of pixels
+   */
+  uint16_t numPixels() const { return this->num_; }
+
+  /**
+   * return how many times show() has been called
+   * @return the number of frames pushed
+   */
+  uint32_t getShowCount() const { return this->shows_; }
+
+ private:
+  /// the pin that drives the strip
+  int16_t pin_;
+
+  /// the number of pixels in the strip
+  uint16_t num_ = 0;
+
+  /// the offset of the white byte within a pixel
+  uint8_t w_offset_;
+
+  /// the offset of the red byte within a pixel
+  uint8_t r_offset_;
+
+  /// the offset of the green byte within a pixel
+  uint8_t g_offset_;
+
+  /// the offset of the blue byte within a pixel
+  uint8_t b_offset_;
+
+  /// the number of bytes per pixel
+  uint8_t bpp_ = 3;
+
+  /// the pixel buffer
+  std::vector<uint8_t> pixels_;
+
+  /// the number of times show() has been called
+  uint32_t shows_ = 0;
+};
+
+#endif  // LIGHTSHOW_HOST_ADAFRUIT_NEOPIXEL_H
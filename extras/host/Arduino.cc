@@ -0,0 +1,174 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "Arduino.h"
+
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "VirtualClock.h"
+
+namespace {
+
+/// the real time at which the program started
+const auto start_time = std::chrono::steady_clock::now();
+
+/**
+ * return the real time since the program started
+ * @return the time in microseconds
+ */
+uint64_t RealMicros() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start_time)
+          .count());
+}
+
+}  // namespace
+
+uint32_t millis() {
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+  auto clock = LightShow::VirtualClock::Installed();
+  if (clock != nullptr) {
+    return clock->Millis();
+  }
+#endif
+  return static_cast<uint32_t>(RealMicros() / 1000);
+}
+
+uint32_t micros() {
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+  auto clock = LightShow::VirtualClock::Installed();
+  if (clock != nullptr) {
+    return clock->Micros();
+  }
+#endif
+  return static_cast<uint32_t>(RealMicros());
+}
+
+void delay(uint32_t ms) {
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+  auto clock = LightShow::VirtualClock::Installed();
+  if (clock != nullptr) {
+    clock->Advance(ms * 1000);
+    return;
+  }
+#endif
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+HardwareSerial Serial;
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size-- > 0) {
+    n += this->write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::print(const char *s) {
+  return this->write(reinterpret_cast<const uint8_t *>(s), strlen(s));
+}
+
+size_t Print::print(unsigned long n, int base) {  // NOLINT(runtime/int)
+  char digits[sizeof(n) * 8 + 1];
+  char *p = digits + sizeof(digits) - 1;
+  *p = '\0';
+  do {
+    const int digit = static_cast<int>(n % base);
+    *--p = static_cast<char>(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    n /= base;
+  } while (n > 0);
+  return this->print(p);
+}
+
+size_t Print::println(const char *s) {
+  return this->print(s) + this->print("\r\n");
+}
+
+size_t Print::println(unsigned long n, int base) {  // NOLINT(runtime/int)
+  return this->print(n, base) + this->print("\r\n");
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return (putchar(c) == EOF) ? 0 : 1;
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length) {
+  size_t n = 0;
+  while (n < length) {
+    const int c = this->read();
+    if (c < 0) {
+      break;
+    }
+    buffer[n++] = static_cast<uint8_t>(c);
+  }
+  return n;
+}
+
+int FileStream::available() {
+  int waiting = 0;
+  if (ioctl(this->fd_, FIONREAD, &waiting) != 0) {
+    waiting = 0;
+  }
+  return static_cast<int>(this->len_ - this->pos_) + waiting;
+}
+
+int FileStream::read() {
+  if (!this->Fill()) {
+    return -1;
+  }
+  return this->buffer_[this->pos_++];
+}
+
+int FileStream::peek() {
+  if (!this->Fill()) {
+    return -1;
+  }
+  return this->buffer_[this->pos_];
+}
+
+size_t FileStream::write(uint8_t c) {
+  return (::write(this->fd_, &c, 1) == 1) ? 1 : 0;
+}
+
+bool FileStream::Fill() {
+  if (this->pos_ < this->len_) {
+    return true;
+  }
+  int waiting = 0;
+  if (ioctl(this->fd_, FIONREAD, &waiting) != 0 || waiting <= 0) {
+    return false;
+  }
+  const ssize_t n = ::read(this->fd_, this->buffer_, sizeof(this->buffer_));
+  this->pos_ = 0;
+  this->len_ = (n > 0) ? static_cast<size_t>(n) : 0;
+  return this->len_ > 0;
+}
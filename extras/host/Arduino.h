@@ -0,0 +1,267 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+///
+/// A minimal stand-in for the Arduino core, so that LightShow can be built and
+/// run on a Linux host.  millis() and micros() follow the installed
+/// LightShow::VirtualClock, or real time if no clock is installed.
+
+#ifndef LIGHTSHOW_HOST_ARDUINO_H
+#define LIGHTSHOW_HOST_ARDUINO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/// program memory is ordinary memory on the host
+#define PROGMEM
+
+/// read a byte from program memory
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t *>(addr))
+
+/// copy bytes from program memory
+#define memcpy_P memcpy
+
+/// measure a string in program memory
+#define strlen_P strlen
+
+/**
+ * return the number of milliseconds since the program started
+ * @return the time in milliseconds
+ */
+uint32_t millis();
+
+/**
+ * return the number of microseconds since the program started
+ * @return the time in microseconds
+ */
+uint32_t micros();
+
+/**
+ * wait for a number of milliseconds
+ * With a VirtualClock installed, this advances the clock instead.
+ * @param ms the number of milliseconds to wait
+ */
+void delay(uint32_t ms);
+
+/// print numbers in base 10
+#define DEC 10
+
+/**
+ * something that text can be printed to
+ */
+class Print {
+ public:
+  virtual ~Print() = default;
+
+  /**
+   * write one byte
+   * @param c the byte to write
+   * @return the number of bytes written
+   */
+  virtual size_t write(uint8_t c) = 0;
+
+  /**
+   * write several bytes
+   * @param buffer the bytes to write
+   * @param size the number of bytes to write
+   * @return the number of bytes written
+   */
+  virtual size_t write(const uint8_t *buffer, size_t size);
+
+  /**
+   * print a string
+   * @param s the string to print
+   * @return the number of bytes written
+   */
+  size_t print(const char *s);
+
+  /**
+   * print a number
+   * @param n the number to print
+   * @param base the base to print it in
+   * @return the number of bytes written
+   */
+  size_t print(unsigned long n, int base = DEC);  // NOLINT(runtime/int)
+
+  /**
+   * print a string followed by a line break
+   * @param s the string to print
+   * @return the number of bytes written
+   */
+  size_t println(const char *s = "");
+
+  /**
+   * print a number followed by a line break
+   * @param n the number to print
+   * @param base the base to print it in
+   * @return the number of bytes written
+   */
+  size_t println(unsigned long n, int base = DEC);  // NOLINT(runtime/int)
+};
+
+/**
+ * something that bytes can be read from, as well as printed to
+ */
+class Stream : public Print {
+ public:
+  /**
+   * return how many bytes can be read without waiting
+   * @return the number of bytes
+   */
+  virtual int available() = 0;
+
+  /**
+   * read one byte
+   * @return the byte, or -1 if none is available
+   */
+  virtual int read() = 0;
+
+  /**
+   * return the next byte without reading it
+   * @return the byte, or -1 if none is available
+   */
+  virtual int peek() = 0;
+
+  /**
+   * read several bytes
+   * Unlike on a board, this does not wait for bytes that have not arrived.
+   * @param buffer where to store the bytes
+   * @param length the most bytes to read
+   * @return the number of bytes read
+   */
+  size_t readBytes(uint8_t *buffer, size_t length);
+
+  /**
+   * read several bytes
+   * @param buffer where to store the bytes
+   * @param length the most bytes to read
+   * @return the number of bytes read
+   */
+  size_t readBytes(char *buffer, size_t length) {
+    return this->readBytes(reinterpret_cast<uint8_t *>(buffer), length);
+  }
+};
+
+/**
+ * the serial port, which writes to stdout and reads nothing on the host
+ */
+class HardwareSerial : public Stream {
+ public:
+  /**
+   * open the port
+   * @param baud the baud rate, which is ignored on the host
+   */
+  void begin(unsigned long baud) { (void)baud; }  // NOLINT(runtime/int)
+
+  /**
+   * return how many bytes can be read without waiting
+   * @return 0
+   */
+  int available() override { return 0; }
+
+  /**
+   * read one byte
+   * @return -1
+   */
+  int read() override { return -1; }
+
+  /**
+   * return the next byte without reading it
+   * @return -1
+   */
+  int peek() override { return -1; }
+
+  /**
+   * write one byte to stdout
+   * @param c the byte to write
+   * @return the number of bytes written
+   */
+  size_t write(uint8_t c) override;
+
+  using Print::write;
+};
+
+/**
+ * a Stream over a file descriptor, such as a file, a pipe or a serial device
+ */
+class FileStream : public Stream {
+ public:
+  /**
+   * wrap a file descriptor
+   * @param fd the open descriptor, which is not closed by the stream
+   */
+  explicit FileStream(int fd) : fd_(fd) {}
+
+  /**
+   * return how many bytes can be read without waiting
+   * @return the number of bytes
+   */
+  int available() override;
+
+  /**
+   * read one byte
+   * @return the byte, or -1 if none is available
+   */
+  int read() override;
+
+  /**
+   * return the next byte without reading it
+   * @return the byte, or -1 if none is available
+   */
+  int peek() override;
+
+  /**
+   * write one byte
+   * @param c the byte to write
+   * @return the number of bytes written
+   */
+  size_t write(uint8_t c) override;
+
+  using Print::write;
+
+ private:
+  /**
+   * read more bytes into the buffer, if any are waiting
+   * @return true if the buffer holds any bytes, else false
+   */
+  bool Fill();
+
+  /// the file descriptor
+  int fd_;
+
+  /// bytes read from fd_ but not yet from the stream
+  uint8_t buffer_[4096];
+
+  /// the offset of the next byte in buffer_
+  size_t pos_ = 0;
+
+  /// the number of bytes in buffer_
+  size_t len_ = 0;
+};
+
+/// the serial port
+extern HardwareSerial Serial;
+
+#endif  // LIGHTSHOW_HOST_ARDUINO_H
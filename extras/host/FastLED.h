@@ -0,0 +1,188 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+///
+/// A minimal stand-in for the FastLED library, so that FastLEDController can be
+/// built and measured on a Linux host.  Only the parts used by LightShow are
+/// provided, and nothing is transmitted.
+
+#ifndef LIGHTSHOW_HOST_FASTLED_H
+#define LIGHTSHOW_HOST_FASTLED_H
+
+#include <Arduino.h>
+
+#include <memory>
+#include <vector>
+
+/**
+ * a single pixel in red, green, blue order
+ */
+struct CRGB {
+  union {
+    struct {
+      /// red 0-255
+      uint8_t r;
+      /// green 0-255
+      uint8_t g;
+      /// blue 0-255
+      uint8_t b;
+    };
+    /// the channels as an array
+    uint8_t raw[3];
+  };
+
+  /// Create an uninitialized pixel
+  CRGB() = default;
+
+  /**
+   * Create a pixel from channel values
+   * @param ir red 0-255
+   * @param ig green 0-255
+   * @param ib blue 0-255
+   */
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+
+  /**
+   * Create a pixel from a color code
+   * @param colorcode the color in 0xRRGGBB format
+   */
+  CRGB(uint32_t colorcode)  // NOLINT(runtime/explicit)
+      : r((colorcode >> 16) & 0xFF),
+        g((colorcode >> 8) & 0xFF),
+        b(colorcode & 0xFF) {}
+};
+
+/**
+ * the controller for a single strip of LEDs
+ */
+class CLEDController {
+ public:
+  /**
+   * Create a controller for a strip
+   * @param leds the pixels of the strip
+   * @param num the number of pixels in the strip
+   */
+  CLEDController(CRGB *leds, int num) : leds_(leds), num_(num) {}
+
+  /**
+   * Push the pixels to the strip
+   * @param brightness the scale to apply to every channel, 0 to 255
+   */
+  void showLeds(uint8_t brightness = 255) { this->brightness_ = brightness; }
+
+  /**
+   * return the brightness applied by the last call to showLeds()
+   * @return the brightness, 0 to 255
+   */
+  uint8_t getBrightness() const { return this->brightness_; }
+
+  /**
+   * return the pixels of the strip
+   * @return the pixels
+   */
+  CRGB *leds() { return this->leds_; }
+
+  /**
+   * Change the pixels that the strip shows
+   * @param data the pixels of the strip
+   * @param num the number of pixels in the strip
+   * @return this controller
+   */
+  CLEDController &setLeds(CRGB *data, int num) {
+    this->leds_ = data;
+    this->num_ = num;
+    return *this;
+  }
+
+  /**
+   * return the number of pixels in the strip
+   * @return the number of pixels
+   */
+  int size() const { return this->num_; }
+
+ private:
+  /// the pixels of the strip
+  CRGB *leds_;
+
+  /// the number of pixels in the strip
+  int num_;
+
+  /// the brightness applied by the last call to showLeds()
+  uint8_t brightness_ = 255;
+};
+
+/// the NeoPixel chipset, selected by type in addLeds()
+template <uint8_t DATA_PIN>
+class NEOPIXEL {};
+
+/**
+ * the global FastLED object, which owns every strip controller
+ */
+class CFastLED {
+ public:
+  /**
+   * Add a strip of LEDs
+   * @tparam CHIPSET the LED chipset
+   * @tparam DATA_PIN the pin that drives the strip
+   * @param data the pixels of the strip
+   * @param num the number of pixels in the strip
+   * @return the controller for the new strip
+   */
+  template <template <uint8_t> class CHIPSET, uint8_t DATA_PIN>
+  CLEDController &addLeds(CRGB *data, int num) {
+    this->controllers_.emplace_back(new CLEDController(data, num));
+    return *this->controllers_.back();
+  }
+
+  /**
+   * Push the pixels of every strip
+   */
+  void show() {
+    for (auto &controller : this->controllers_) {
+      controller->showLeds();
+    }
+  }
+
+  /**
+   * return the number of strips that have been added
+   * @return the number of strips
+   */
+  int count() const { return static_cast<int>(this->controllers_.size()); }
+
+  /**
+   * return a strip that has been added
+   * @param x the index of the strip, in the order it was added
+   * @return the controller for the strip
+   */
+  CLEDController &operator[](int x) { return *this->controllers_[x]; }
+
+ private:
+  /// every strip that has been added
+  std::vector<std::unique_ptr<CLEDController>> controllers_;
+};
+
+/// the global FastLED object
+extern CFastLED FastLED;
+
+#endif  // LIGHTSHOW_HOST_FASTLED_H
@@ -0,0 +1,102 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "HeapCounter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+/// the number of times operator new has been called
+std::atomic<uint64_t> heap_allocations(0);
+
+/// the number of bytes allocated and not yet freed
+std::atomic<uint64_t> heap_bytes(0);
+
+/// the space ahead of each allocation that records its size, which keeps the
+/// memory handed out aligned for any type
+constexpr std::size_t kHeader = alignof(std::max_align_t);
+
+/**
+ * allocate memory and count the allocation
+ * @param size the number of bytes to allocate
+ * @return the memory, or nullptr if none is available
+ */
+void *CountedMalloc(std::size_t size) {
+  auto *block = static_cast<unsigned char *>(std::malloc(kHeader + size));
+  if (block == nullptr) {
+    return nullptr;
+  }
+  *reinterpret_cast<std::size_t *>(block) = size;
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  heap_bytes.fetch_add(size, std::memory_order_relaxed);
+  return block + kHeader;
+}
+
+/**
+ * free memory allocated by CountedMalloc()
+ * @param p the memory, or nullptr
+ */
+void CountedFree(void *p) {
+  if (p == nullptr) {
+    return;
+  }
+  auto *block = static_cast<unsigned char *>(p) - kHeader;
+  heap_bytes.fetch_sub(*reinterpret_cast<std::size_t *>(block),
+                       std::memory_order_relaxed);
+  std::free(block);
+}
+
+}  // namespace
+
+// the standard library builds the array forms on these
+void *operator new(std::size_t size) {
+  void *p = CountedMalloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return CountedMalloc(size);
+}
+
+void operator delete(void *p) noexcept { CountedFree(p); }
+
+void operator delete(void *p, std::size_t) noexcept { CountedFree(p); }
+
+namespace LightShow {
+
+uint64_t GetHeapAllocations() {
+  return heap_allocations.load(std::memory_order_relaxed);
+}
+
+uint64_t GetHeapBytes() { return heap_bytes.load(std::memory_order_relaxed); }
+
+}  // namespace LightShow
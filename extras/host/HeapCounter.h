@@ -0,0 +1,59 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+///
+/// Counts every heap allocation made by a host build, by replacing the global
+/// operator new.  Controllers report the buffers they allocate through
+/// GetAllocationCount(), but only this counter sees allocations that nobody
+/// remembered to report, such as a std::vector growing on the render path.
+/// It also keeps the number of bytes in use, including the buffers of the
+/// stubbed strip libraries, so that the memory held by a controller can be
+/// measured.
+
+#ifndef LIGHTSHOW_HOST_HEAPCOUNTER_H
+#define LIGHTSHOW_HOST_HEAPCOUNTER_H
+
+#include <stdint.h>
+
+namespace LightShow {
+
+/**
+ * return how many times operator new has been called
+ * Every thread is counted, so compare two readings taken around the code
+ * under test to check that it does not allocate.
+ * @return the number of heap allocations made so far
+ */
+uint64_t GetHeapAllocations();
+
+/**
+ * return how many bytes allocated with operator new have not been freed
+ * Compare two readings taken around the creation of an object to find how
+ * much memory it holds.
+ * @return the number of bytes in use
+ */
+uint64_t GetHeapBytes();
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_HOST_HEAPCOUNTER_H
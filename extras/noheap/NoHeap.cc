@@ -0,0 +1,96 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+/// A strip driven without the heap, built on the host to check that the
+/// LIGHTSHOW_NO_HEAP subset of the library never allocates.  The CI workflow
+/// compiles this file and every file in src with LIGHTSHOW_NO_HEAP set, then
+/// fails if any of the objects needs malloc, calloc, realloc or operator new
+/// from outside.
+
+#include <Arduino.h>
+
+#include <cstdio>
+
+#include "FlashColorPreset.h"
+#include "OutputStage.h"
+#include "PulseColorPreset.h"
+#include "Show.h"
+#include "SolidColorPreset.h"
+#include "StaticController.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+#error "build this check with LIGHTSHOW_NO_HEAP set to 1"
+#endif
+
+namespace {
+
+/// the number of LEDs in the strip
+constexpr uint32_t kLEDs = 30;
+
+/// the strip, its frame and fade snapshot held in .bss
+LightShow::StaticController<kLEDs, LightShow::NullBackend> controller;
+
+/// gamma and brightness, applied by backends that copy the frame
+LightShow::OutputStage stage;
+
+/// the presets, each holding a plain pointer to the controller
+LightShow::BasicPulseColorPreset<decltype(controller)> pulse(controller, 0xFF,
+                                                              0x80, 0x00, 1,
+                                                              10);
+LightShow::BasicFlashColorPreset<decltype(controller)> flash(controller, 0x00,
+                                                              0x00, 0xFF);
+LightShow::BasicSolidColorPreset<decltype(controller)> solid(controller, 0x20,
+                                                              0x20, 0x20);
+
+/// the presets that the show can call
+LightShow::Preset *const kPresets[] = {&pulse, &flash, &solid};
+
+/// set red, fade to blue, then run each preset for a moment
+const uint8_t kShow[] PROGMEM = {
+    LightShow::kShowSet,  0xFF, 0x00, 0x00,         // red
+    LightShow::kShowFade, 0x00, 0x00, 0xFF, 20, 0,  // fade to blue
+    LightShow::kShowCall, 0,    20,   0,            // pulse
+    LightShow::kShowCall, 1,    20,   0,            // flash
+    LightShow::kShowCall, 2,    20,   0,            // solid
+    LightShow::kShowEnd};
+
+}  // namespace
+
+int main() {
+  stage.SetGamma(LightShow::Curve::Gamma22);
+  controller.SetOutputStage(&stage);
+  controller.SetShowPresets(kPresets, 3);
+  controller.Play(kShow);
+  while (controller.IsPlaying()) {
+    controller.Loop();
+  }
+
+  LightShow::Pixel pixel;
+  const auto e = controller.GetFrame(kLEDs, &pixel, 1);
+  printf("last pixel %d %d %d\n", controller.GetPixels()[kLEDs - 1].r,
+         controller.GetPixels()[kLEDs - 1].g,
+         controller.GetPixels()[kLEDs - 1].b);
+  printf("reading past the end: %s\n", LightShow::DescribeErrorP(e));
+  return 0;
+}
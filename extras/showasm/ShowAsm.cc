@@ -0,0 +1,239 @@
+/// @file
+///
+/// An assembler for LightShow show programs, run on a Linux host.  It reads a
+/// text program and prints it as a PROGMEM array, ready to paste into a
+/// sketch and pass to Controller::Play(), or as raw bytes with --bin.
+///
+/// Build from the repository root:
+///
+///     g++ -std=c++11 -Iextras/host -Isrc extras/showasm/ShowAsm.cc -o showasm
+///
+/// Usage: showasm [--bin] [--name NAME] [FILE]
+///
+/// Each line holds one instruction; colors are RRGGBB in hex, and durations
+/// are in milliseconds, up to 65535.  A word followed by a colon labels the
+/// next instruction, and # starts a comment.
+///
+///     top:
+///       set 000000
+///       fade FF0000 500      # to red over half a second
+///       hold 1000
+///       call 0 2000          # run preset 0 for two seconds
+///       loop top 3           # run from top three times (0 is forever)
+///       end
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Show.h"
+
+namespace {
+
+/// an instruction whose label operand is resolved once every label is known
+struct Fixup {
+  /// the offset of the 16-bit operand to fill in
+  size_t offset;
+
+  /// the label whose offset goes in the operand
+  std::string label;
+
+  /// the line that used the label, for error messages
+  int line;
+};
+
+/**
+ * print an error and exit
+ * @param line the line of the program that caused the error
+ * @param message what went wrong
+ */
+[[noreturn]] void Fail(int line, const std::string &message) {
+  fprintf(stderr, "line %d: %s\n", line, message.c_str());
+  exit(1);
+}
+
+/**
+ * parse a number, failing if it is not valid or out of range
+ * @param text the text to parse
+ * @param base the base of the number
+ * @param max the largest allowed value
+ * @param line the line being parsed, for error messages
+ * @return the value of the number
+ */
+uint32_t ParseNumber(const std::string &text, int base, uint32_t max,
+                     int line) {
+  char *end = nullptr;
+  const unsigned long value =  // NOLINT(runtime/int)
+      strtoul(text.c_str(), &end, base);
+  if (text.empty() || *end != '\0' || value > max) {
+    Fail(line, "bad number '" + text + "'");
+  }
+  return static_cast<uint32_t>(value);
+}
+
+/**
+ * append a color operand
+ * @param text the color in RRGGBB hex
+ * @param line the line being parsed, for error messages
+ * @param out the program to append to
+ */
+void EmitColor(const std::string &text, int line, std::vector<uint8_t> *out) {
+  if (text.size() != 6) {
+    Fail(line, "colors are written as RRGGBB");
+  }
+  const uint32_t color = ParseNumber(text, 16, 0xFFFFFF, line);
+  out->push_back(static_cast<uint8_t>(color >> 16));
+  out->push_back(static_cast<uint8_t>(color >> 8));
+  out->push_back(static_cast<uint8_t>(color));
+}
+
+/**
+ * append a 16-bit little-endian operand
+ * @param value the value of the operand
+ * @param out the program to append to
+ */
+void EmitWord(uint32_t value, std::vector<uint8_t> *out) {
+  out->push_back(static_cast<uint8_t>(value));
+  out->push_back(static_cast<uint8_t>(value >> 8));
+}
+
+/**
+ * assemble a program
+ * @param in the text of the program
+ * @return the bytes of the program
+ */
+std::vector<uint8_t> Assemble(std::istream &in) {  // NOLINT(runtime/references)
+  std::vector<uint8_t> out;
+  std::map<std::string, size_t> labels;
+  std::vector<Fixup> fixups;
+  std::string text;
+  bool ended = false;
+  for (int line = 1; std::getline(in, text); line++) {
+    text = text.substr(0, text.find('#'));
+    std::istringstream words(text);
+    std::vector<std::string> args;
+    for (std::string word; words >> word;) {
+      args.push_back(word);
+    }
+
+    // labels may share a line with an instruction
+    while (!args.empty() && args[0].back() == ':') {
+      const auto name = args[0].substr(0, args[0].size() - 1);
+      if (!labels.emplace(name, out.size()).second) {
+        Fail(line, "label '" + name + "' is defined twice");
+      }
+      args.erase(args.begin());
+    }
+    if (args.empty()) {
+      continue;
+    }
+
+    const auto &op = args[0];
+    auto expect = [&](size_t count) {
+      if (args.size() != count + 1) {
+        Fail(line, "'" + op + "' takes " + std::to_string(count) +
+                       " operand(s)");
+      }
+    };
+    ended = false;
+    if (op == "end") {
+      expect(0);
+      out.push_back(LightShow::kShowEnd);
+      ended = true;
+    } else if (op == "set") {
+      expect(1);
+      out.push_back(LightShow::kShowSet);
+      EmitColor(args[1], line, &out);
+    } else if (op == "fade") {
+      expect(2);
+      out.push_back(LightShow::kShowFade);
+      EmitColor(args[1], line, &out);
+      EmitWord(ParseNumber(args[2], 10, 0xFFFF, line), &out);
+    } else if (op == "hold") {
+      expect(1);
+      out.push_back(LightShow::kShowHold);
+      EmitWord(ParseNumber(args[1], 10, 0xFFFF, line), &out);
+    } else if (op == "loop") {
+      expect(2);
+      out.push_back(LightShow::kShowLoop);
+      fixups.push_back({out.size(), args[1], line});
+      EmitWord(0, &out);
+      out.push_back(static_cast<uint8_t>(ParseNumber(args[2], 10, 0xFF, line)));
+    } else if (op == "call") {
+      expect(2);
+      out.push_back(LightShow::kShowCall);
+      out.push_back(static_cast<uint8_t>(ParseNumber(args[1], 10, 0xFF, line)));
+      EmitWord(ParseNumber(args[2], 10, 0xFFFF, line), &out);
+    } else {
+      Fail(line, "unknown instruction '" + op + "'");
+    }
+  }
+
+  // every program stops somewhere
+  if (!ended) {
+    out.push_back(LightShow::kShowEnd);
+  }
+
+  for (const auto &fixup : fixups) {
+    const auto label = labels.find(fixup.label);
+    if (label == labels.end()) {
+      Fail(fixup.line, "label '" + fixup.label + "' is not defined");
+    }
+    out[fixup.offset] = static_cast<uint8_t>(label->second);
+    out[fixup.offset + 1] = static_cast<uint8_t>(label->second >> 8);
+  }
+  if (out.size() > 0x10000) {
+    Fail(0, "programs are limited to 65536 bytes");
+  }
+  return out;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  bool binary = false;
+  std::string name = "kShow";
+  const char *path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--bin") == 0) {
+      binary = true;
+    } else if (strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+      name = argv[++i];
+    } else if (argv[i][0] != '-' && path == nullptr) {
+      path = argv[i];
+    } else {
+      fprintf(stderr, "usage: %s [--bin] [--name NAME] [FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<uint8_t> program;
+  if (path != nullptr) {
+    std::ifstream file(path);
+    if (!file) {
+      fprintf(stderr, "cannot open %s\n", path);
+      return 1;
+    }
+    program = Assemble(file);
+  } else {
+    program = Assemble(std::cin);
+  }
+
+  if (binary) {
+    fwrite(program.data(), 1, program.size(), stdout);
+    return 0;
+  }
+  printf("const uint8_t %s[] PROGMEM = {", name.c_str());
+  for (size_t i = 0; i < program.size(); i++) {
+    printf("%s0x%02X", (i == 0) ? "\n    " : (i % 12 == 0) ? ",\n    " : ", ",
+           program[i]);
+  }
+  printf("};\n");
+  return 0;
+}
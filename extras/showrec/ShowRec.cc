@@ -0,0 +1,300 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FlashColorPreset.h"
+#include "FrameSource.h"
+#include "PlaybackPreset.h"
+#include "PulseColorPreset.h"
+#include "SimulatedController.h"
+#include "SolidColorPreset.h"
+#include "VirtualClock.h"
+
+namespace {
+
+using LightShow::Pixel;
+namespace ShowFile = LightShow::ShowFile;
+
+/**
+ * append a little-endian 32-bit number
+ * @param value the number
+ * @param out the file to append to
+ */
+void EmitLE32(uint32_t value, std::vector<uint8_t> *out) {
+  for (int i = 0; i < 4; i++) {
+    out->push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+/**
+ * count how many times the pixel at pos repeats in a row
+ * @param d the XOR of two frames
+ * @param pos the offset of the pixel
+ * @param total the length of d
+ * @return the number of pixels, up to ShowFile::kMaxRun
+ */
+size_t CountRepeats(const uint8_t *d, size_t pos, size_t total) {
+  size_t n = 1;
+  while (n < ShowFile::kMaxRun && pos + (n + 1) * sizeof(Pixel) <= total &&
+         memcmp(d + pos, d + pos + n * sizeof(Pixel), sizeof(Pixel)) == 0) {
+    n++;
+  }
+  return n;
+}
+
+/**
+ * count how many zero bytes start at pos
+ * @param d the XOR of two frames
+ * @param pos the offset to start at
+ * @param total the length of d
+ * @param max the most bytes to count
+ * @return the number of zero bytes
+ */
+size_t CountZeros(const uint8_t *d, size_t pos, size_t total, size_t max) {
+  size_t n = 0;
+  while (n < max && pos + n < total && d[pos + n] == 0) {
+    n++;
+  }
+  return n;
+}
+
+/**
+ * append one frame
+ * @param from the frame before, or all black for a keyframe
+ * @param to the frame to encode
+ * @param key true to write a keyframe
+ * @param out the file to append to
+ */
+void EncodeFrame(const std::vector<Pixel> &from, const std::vector<Pixel> &to,
+                 bool key, std::vector<uint8_t> *out) {
+  const size_t total = to.size() * sizeof(Pixel);
+  std::vector<uint8_t> d(total);
+  const auto *a = reinterpret_cast<const uint8_t *>(from.data());
+  const auto *b = reinterpret_cast<const uint8_t *>(to.data());
+  for (size_t i = 0; i < total; i++) {
+    d[i] = key ? b[i] : (a[i] ^ b[i]);
+  }
+
+  std::vector<uint8_t> body;
+  size_t pos = 0;
+  while (pos < total) {
+    // skip unchanged bytes; a run to the end of the frame needs no token
+    const size_t zeros = CountZeros(d.data(), pos, total, ShowFile::kMaxSkip);
+    if (zeros > 0) {
+      if (pos + zeros < total) {
+        body.push_back(static_cast<uint8_t>(zeros - 1));
+      }
+      pos += zeros;
+      continue;
+    }
+
+    const size_t repeats = (pos + 2 * sizeof(Pixel) <= total)
+                               ? CountRepeats(d.data(), pos, total)
+                               : 1;
+    if (repeats > 1) {
+      body.push_back(
+          static_cast<uint8_t>(ShowFile::kRepeat | (repeats - 1)));
+      body.insert(body.end(), d.begin() + pos,
+                  d.begin() + pos + sizeof(Pixel));
+      pos += repeats * sizeof(Pixel);
+      continue;
+    }
+
+    // take bytes until a run that a skip or a repeat would cover better
+    size_t n = 1;
+    while (n < ShowFile::kMaxRun && pos + n < total &&
+           CountZeros(d.data(), pos + n, total, 2) < 2 &&
+           (pos + n + 2 * sizeof(Pixel) > total ||
+            CountRepeats(d.data(), pos + n, total) < 2)) {
+      n++;
+    }
+    body.push_back(static_cast<uint8_t>(ShowFile::kLiteral | (n - 1)));
+    body.insert(body.end(), d.begin() + pos, d.begin() + pos + n);
+    pos += n;
+  }
+
+  out->push_back(key ? ShowFile::kFrameKey : ShowFile::kFrameDelta);
+  EmitLE32(static_cast<uint32_t>(body.size()), out);
+  out->insert(out->end(), body.begin(), body.end());
+}
+
+/**
+ * print usage and exit
+ * @param name the name of the program
+ */
+[[noreturn]] void Usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [--preset solid|pulse|flash|showN] [--color RRGGBB]\n"
+          "       [--pixels N] [--fps N] [--seconds N] [--keyframe N]\n"
+          "       [--bin] [--name NAME]\n",
+          name);
+  exit(1);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::string preset_name = "pulse";
+  uint32_t color = 0xFF8000;
+  uint32_t pixels = 60;
+  uint32_t fps = 30;
+  uint32_t seconds = 10;
+  uint32_t keyframe = 0;
+  bool binary = false;
+  std::string name = "kRecording";
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (strcmp(argv[i], "--bin") == 0) {
+      binary = true;
+    } else if (strcmp(argv[i], "--preset") == 0 && has_value) {
+      preset_name = argv[++i];
+    } else if (strcmp(argv[i], "--color") == 0 && has_value) {
+      color = strtoul(argv[++i], nullptr, 16);
+    } else if (strcmp(argv[i], "--pixels") == 0 && has_value) {
+      pixels = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--fps") == 0 && has_value) {
+      fps = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--seconds") == 0 && has_value) {
+      seconds = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--keyframe") == 0 && has_value) {
+      keyframe = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--name") == 0 && has_value) {
+      name = argv[++i];
+    } else {
+      Usage(argv[0]);
+    }
+  }
+  if (pixels == 0 || fps == 0 || fps > 1000) {
+    Usage(argv[0]);
+  }
+
+  LightShow::VirtualClock clock;
+  LightShow::VirtualClock::Install(&clock);
+  auto controller = std::make_shared<LightShow::SimulatedController>(pixels);
+  const auto r = static_cast<uint8_t>(color >> 16);
+  const auto g = static_cast<uint8_t>(color >> 8);
+  const auto b = static_cast<uint8_t>(color);
+  std::unique_ptr<LightShow::Preset> preset;
+  if (preset_name == "solid") {
+    preset.reset(new LightShow::SolidColorPreset(controller, r, g, b));
+  } else if (preset_name == "pulse") {
+    auto pulse = new LightShow::PulseColorPreset(controller, r, g, b);
+    pulse->SetPeriod(2000);
+    preset.reset(pulse);
+  } else if (preset_name == "flash") {
+    auto flash = new LightShow::FlashColorPreset(controller, r, g, b);
+    flash->SetPeriod(1000);
+    preset.reset(flash);
+  } else if (preset_name.compare(0, 4, "show") == 0) {
+    preset.reset(new LightShow::Preset());
+    if (controller->Start(atoi(preset_name.c_str() + 4)) !=
+        LightShow::NoError) {
+      Usage(argv[0]);
+    }
+  } else {
+    Usage(argv[0]);
+  }
+
+  // capture the preset, one frame per period of the virtual clock
+  const uint32_t frame_ms = 1000 / fps;
+  const uint32_t frame_count = seconds * fps;
+  std::vector<std::vector<Pixel>> frames;
+  preset->Start();
+  for (uint32_t f = 0; f < frame_count; f++) {
+    preset->Loop();
+    if (controller->IsFading() || controller->IsPlaying()) {
+      controller->Loop();
+    }
+    frames.push_back(controller->GetPixels());
+    clock.Advance(frame_ms * 1000);
+  }
+
+  std::vector<uint8_t> file = {'L', 'S', 'F', '1'};
+  EmitLE32(pixels, &file);
+  EmitLE32(frame_count, &file);
+  file.push_back(static_cast<uint8_t>(frame_ms));
+  file.push_back(static_cast<uint8_t>(frame_ms >> 8));
+  file.push_back(0);
+  file.push_back(0);
+  const std::vector<Pixel> black(pixels, Pixel());
+  for (uint32_t f = 0; f < frame_count; f++) {
+    const bool key = f == 0 || (keyframe != 0 && f % keyframe == 0);
+    EncodeFrame(key ? black : frames[f - 1], frames[f], key, &file);
+  }
+
+  // play the recording back as fast as it will go, checking every frame
+  auto player = std::make_shared<LightShow::SimulatedController>(pixels);
+  LightShow::MemoryFrameSource source(file.data(), file.size(), false);
+  LightShow::PlaybackPreset playback(player, &source);
+  playback.SetRepeat(false);
+  clock.Advance(0);
+  playback.Start();
+  double decode_s = 0;
+  uint32_t mismatches = 0;
+  for (uint32_t f = 0; f < frame_count; f++) {
+    const auto start = std::chrono::steady_clock::now();
+    playback.Loop();
+    decode_s += std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    if (memcmp(player->GetPixels().data(), frames[f].data(),
+               pixels * sizeof(Pixel)) != 0) {
+      mismatches++;
+    }
+    clock.Advance(frame_ms * 1000);
+  }
+
+  const double raw = static_cast<double>(frame_count) * pixels * sizeof(Pixel);
+  fprintf(stderr, "%u frames of %u pixels at %u ms\n", frame_count, pixels,
+          frame_ms);
+  fprintf(stderr, "raw %.0f bytes, encoded %zu bytes, ratio %.1f:1\n", raw,
+          file.size(), raw / file.size());
+  fprintf(stderr, "decode %.1f MB/s of pixels, %.0f frames/s\n",
+          raw / decode_s / 1e6, frame_count / decode_s);
+  if (mismatches != 0) {
+    fprintf(stderr, "%u frames did not decode to the captured frame\n",
+            mismatches);
+    return 1;
+  }
+
+  if (binary) {
+    fwrite(file.data(), 1, file.size(), stdout);
+    return 0;
+  }
+  printf("const uint8_t %s[] PROGMEM = {", name.c_str());
+  for (size_t i = 0; i < file.size(); i++) {
+    printf("%s0x%02X", (i == 0) ? "\n    " : (i % 12 == 0) ? ",\n    " : ", ",
+           file[i]);
+  }
+  printf("};\n");
+  return 0;
+}
@@ -0,0 +1,289 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+///
+/// Host checks for behavior that is easy to break without noticing on a
+/// strip, run against the simulated backend and the stubbed hardware
+/// libraries in extras/host.  Each check prints a line when it fails, and the
+/// program exits with the number of failures.
+///
+/// Build and run from the repository root, as a single command:
+///
+///     g++ -std=c++11 -DLIGHTSHOW_SIMULATED_ENABLE=1 -Iextras/host -Isrc
+///         extras/tests/Tests.cc src/*.cc extras/host/*.cc -o tests && ./tests
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#include <cstdio>
+#include <memory>
+
+#include "Compositor.h"
+#include "FrameSource.h"
+#include "PlaybackPreset.h"
+#include "PulseColorPreset.h"
+#include "Scheduler.h"
+#include "SimulatedController.h"
+#include "SolidColorPreset.h"
+#include "StaticController.h"
+#include "VirtualClock.h"
+
+namespace {
+
+/// the number of checks that have failed
+int failures = 0;
+
+/**
+ * record the outcome of a check
+ * @param ok true if the check passed
+ * @param test the name of the test making the check
+ * @param what a description of what was checked
+ */
+void Check(bool ok, const char *test, const char *what) {
+  if (!ok) {
+    printf("FAIL %s: %s\n", test, what);
+    failures++;
+  }
+}
+
+/**
+ * a pulse with no steps bounces between off and the full color, instead of
+ * stepping down from 0 and wrapping around
+ */
+void TestPulseWithoutSteps() {
+  auto controller = std::make_shared<LightShow::SimulatedController>(4);
+  LightShow::PulseColorPreset preset(controller, 0xFF, 0x80, 0x40, 1, 0);
+  preset.Start();
+  for (int i = 0; i < 8; i++) {
+    preset.Loop();
+    const uint8_t expected = (i % 2 == 0) ? 0x00 : 0xFF;
+    Check(controller->GetPixels()[0].r == expected, "pulse_without_steps",
+          "the pulse alternates between off and full");
+  }
+}
+
+/**
+ * changing only a layer's alpha is enough for the compositor to blend the
+ * layers again
+ */
+void TestLayerAlpha() {
+  auto controller = std::make_shared<LightShow::SimulatedController>(4);
+  LightShow::Compositor compositor(controller, 4);
+  auto base = compositor.AddLayer(LightShow::BlendMode::Normal);
+  auto top = compositor.AddLayer(LightShow::BlendMode::Alpha);
+  base->SetLEDs(0x00, 0x00, 0x00);
+  top->SetLEDs(0xFF, 0xFF, 0xFF);
+  top->SetAlphas(0x00);
+  compositor.Update();
+  Check(controller->GetPixels()[0].r == 0x00, "layer_alpha",
+        "a transparent layer leaves the layer below");
+
+  top->SetAlphas(0xFF);
+  compositor.Update();
+  Check(controller->GetPixels()[0].r == 0xFF, "layer_alpha",
+        "SetAlphas() is shown on the next update");
+
+  Check(top->SetAlpha(1, 0x00) == LightShow::NoError, "layer_alpha",
+        "SetAlpha() accepts an LED in range");
+  compositor.Update();
+  Check(controller->GetPixels()[1].r == 0x00, "layer_alpha",
+        "SetAlpha() is shown on the next update");
+  Check(controller->GetPixels()[0].r == 0xFF, "layer_alpha",
+        "SetAlpha() changes only its own LED");
+}
+
+/**
+ * a scheduled frame is pushed when something changed it, and skipped when
+ * nothing did
+ */
+void TestSchedulerSkipsUnchanged() {
+  auto *previous = LightShow::VirtualClock::Installed();
+  LightShow::VirtualClock clock;
+  LightShow::VirtualClock::Install(&clock);
+  auto controller = std::make_shared<LightShow::SimulatedController>(4);
+  LightShow::Scheduler scheduler(controller, 100);
+  scheduler.AddPreset(
+      std::make_shared<LightShow::SolidColorPreset>(controller, 0xFF, 0, 0));
+  scheduler.Start(0);
+  for (int i = 0; i < 5; i++) {
+    scheduler.Loop();
+    clock.Advance(10000);
+  }
+  Check(controller->GetFrameCount() == 1, "scheduler_skips_unchanged",
+        "a solid color is pushed once");
+  Check(controller->GetPixels()[0].r == 0xFF, "scheduler_skips_unchanged",
+        "the color set by Start() is pushed");
+
+  controller->SetLED(0, 0, 0xFF, 0);
+  scheduler.Loop();
+  Check(controller->GetFrameCount() == 2, "scheduler_skips_unchanged",
+        "a frame written between ticks is pushed");
+
+  LightShow::OutputStage stage;
+  controller->SetOutputStage(&stage);
+  clock.Advance(10000);
+  scheduler.Loop();
+  stage.SetBrightness(0x80);
+  clock.Advance(10000);
+  scheduler.Loop();
+  Check(controller->GetFrameCount() == 4, "scheduler_skips_unchanged",
+        "an output stage change is pushed");
+  LightShow::VirtualClock::Install(previous);
+}
+
+/**
+ * a recorded show is decoded over the controller's own frame, and a show
+ * longer than the strip sets the pixels that fit
+ */
+void TestPlaybackIntoController() {
+  // 40 pixels: a keyframe of one repeated pixel, then a delta that skips 30
+  // pixels and XORs a literal into the 31st
+  const uint8_t show[] = {
+      'L', 'S', 'F', '1', 40, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0,
+      LightShow::ShowFile::kFrameKey, 4, 0, 0, 0,
+      LightShow::ShowFile::kRepeat | 39, 1, 2, 3,
+      0, 5, 0, 0, 0,
+      89, LightShow::ShowFile::kLiteral | 2, 0x10, 0x20, 0x30};
+
+  auto full = std::make_shared<LightShow::SimulatedController>(40);
+  LightShow::MemoryFrameSource full_source(show, sizeof(show), false);
+  LightShow::PlaybackPreset full_show(full, &full_source);
+  full_show.SetRepeat(false);
+  full_show.Start();
+  full_show.Loop();
+  const auto &first = full->GetPixels();
+  Check(first[0].b == 3 && first[39].b == 3, "playback_into_controller",
+        "a keyframe sets every pixel");
+  full_show.Loop();
+  const auto &second = full->GetPixels();
+  Check(second[30].r == 0x11 && second[30].g == 0x22 && second[30].b == 0x33,
+        "playback_into_controller", "a delta is XORed over the last frame");
+  Check(second[29].r == 1 && second[31].r == 1, "playback_into_controller",
+        "a delta leaves the pixels it skips");
+  Check(full->GetFrameCount() == 2, "playback_into_controller",
+        "each frame is pushed once");
+
+  auto part = std::make_shared<LightShow::SimulatedController>(20);
+  LightShow::MemoryFrameSource part_source(show, sizeof(show), false);
+  LightShow::PlaybackPreset part_show(part, &part_source);
+  part_show.SetRepeat(false);
+  part_show.Start();
+  part_show.Loop();
+  part_show.Loop();
+  Check(part->GetPixels()[19].g == 2, "playback_into_controller",
+        "a show longer than the strip sets the pixels that fit");
+}
+
+/**
+ * a FastLED strip of a static controller sends its frame through the output
+ * stage, and leaves the frame that presets draw into alone
+ */
+void TestFastLEDBackendStage() {
+  LightShow::StaticController<4, LightShow::FastLEDBackend<7>> controller;
+  LightShow::OutputStage stage;
+  stage.SetBrightness(0x40);
+  controller.SetOutputStage(&stage);
+  controller.SetLEDs(0xFF, 0x80, 0x00);
+  Check(controller.Update() == LightShow::NoError, "fastled_backend_stage",
+        "the update succeeds");
+  const CRGB *sent = FastLED[FastLED.count() - 1].leds();
+  Check(sent[3].r == 0x40 && sent[3].g == 0x20 && sent[3].b == 0,
+        "fastled_backend_stage", "the sent frame is corrected");
+  Check(controller.GetPixels()[3].r == 0xFF, "fastled_backend_stage",
+        "the frame is left uncorrected");
+
+  controller.SetOutputStage(nullptr);
+  controller.Update();
+  sent = FastLED[FastLED.count() - 1].leds();
+  Check(sent[3].r == 0xFF, "fastled_backend_stage",
+        "the frame is sent as is once the stage is removed");
+}
+
+/**
+ * a FastLED strip of a static controller with a dimming stage and a power
+ * budget draws no more than the budget on the wire
+ */
+void TestFastLEDBackendBudget() {
+  constexpr uint32_t kLEDs = 10;
+  LightShow::StaticController<kLEDs, LightShow::FastLEDBackend<8>> controller;
+  LightShow::OutputStage stage;
+  stage.SetBrightness(0x40);
+  controller.SetOutputStage(&stage);
+  controller.SetLEDs(0xFF, 0xFF, 0xFF);
+  for (const uint32_t budget : {100u, 200u}) {
+    controller.SetPowerBudget(budget);
+    controller.Update();
+    // the current drawn by what was sent, in the default power model of 20mA
+    // per channel and 1mA per pixel
+    CLEDController &strip = FastLED[FastLED.count() - 1];
+    uint32_t levels = 0;
+    for (uint32_t i = 0; i < kLEDs; i++) {
+      levels += strip.leds()[i].r + strip.leds()[i].g + strip.leds()[i].b;
+    }
+    const uint32_t drawn =
+        levels * strip.getBrightness() / 0xFF * 20 / 0xFF + kLEDs;
+    Check(drawn <= budget, "fastled_backend_budget",
+          "the strip draws no more than the budget");
+    Check(drawn * 2 > budget, "fastled_backend_budget",
+          "the strip is not dimmed more than the budget needs");
+  }
+}
+
+/**
+ * a static controller crossfades onto its target when it holds a buffer for
+ * it, and refuses to when it was built without one
+ */
+void TestStaticCrossFade() {
+  LightShow::StaticController<4, LightShow::NullBackend> controller;
+  const LightShow::Pixel target[4] = {
+      {0xFF, 0, 0}, {0, 0xFF, 0}, {0, 0, 0xFF}, {0x10, 0x20, 0x30}};
+  const auto e = controller.CrossFade(0, target, 4);
+#if LIGHTSHOW_STATIC_CROSSFADE == 1
+  Check(e == LightShow::NoError, "static_crossfade", "the crossfade succeeds");
+  Check(controller.GetPixels()[1].g == 0xFF &&
+            controller.GetPixels()[3].b == 0x30,
+        "static_crossfade", "every pixel lands on its target");
+#else
+  Check(e == LightShow::CrossFadeUnsupported, "static_crossfade",
+        "the crossfade is refused");
+#endif
+}
+
+}  // namespace
+
+int main() {
+  LightShow::VirtualClock clock;
+  LightShow::VirtualClock::Install(&clock);
+
+  TestPulseWithoutSteps();
+  TestLayerAlpha();
+  TestSchedulerSkipsUnchanged();
+  TestPlaybackIntoController();
+  TestFastLEDBackendStage();
+  TestFastLEDBackendBudget();
+  TestStaticCrossFade();
+
+  printf("%d failures\n", failures);
+  return failures;
+}
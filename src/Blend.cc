@@ -0,0 +1,86 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "Blend.h"
+
+#include "Lerp.h"
+
+namespace LightShow {
+
+namespace {
+
+/**
+ * convert a byte fraction to a lerp weight
+ * @param v the fraction, where 255 means all of the way
+ * @return the weight in Q8 fixed point, 0 to kLerpOne
+ */
+inline uint16_t ToWeight(uint8_t v) { return v + (v >> 7); }
+
+}  // namespace
+
+void BlendBuffer(uint8_t *dst, const uint8_t *src, size_t len, BlendMode mode,
+                 uint8_t opacity) {
+  const uint16_t weight = ToWeight(opacity);
+  switch (mode) {
+    case BlendMode::Add:
+      for (size_t i = 0; i < len; i++) {
+        const uint16_t sum = dst[i] + ((src[i] * weight) >> 8);
+        dst[i] = static_cast<uint8_t>(sum > 255 ? 255 : sum);
+      }
+      break;
+    case BlendMode::Multiply:
+      for (size_t i = 0; i < len; i++) {
+        const uint16_t product = (dst[i] * (src[i] + 1)) >> 8;
+        dst[i] = Lerp8(dst[i], static_cast<uint8_t>(product), weight);
+      }
+      break;
+    case BlendMode::Max:
+      for (size_t i = 0; i < len; i++) {
+        const uint8_t high = dst[i] > src[i] ? dst[i] : src[i];
+        dst[i] = Lerp8(dst[i], high, weight);
+      }
+      break;
+    case BlendMode::Alpha:
+    case BlendMode::Normal:
+    default:
+      // without per-pixel alpha, covering is a lerp towards the layer
+      LerpBuffer(dst, dst, src, len, weight);
+      break;
+  }
+}
+
+void BlendAlpha(uint8_t *dst, const uint8_t *src, const uint8_t *alpha,
+                size_t count, uint8_t stride, uint8_t opacity) {
+  for (size_t i = 0; i < count; i++) {
+    const uint16_t weight = ToWeight(Scale8(alpha[i], opacity));
+    for (uint8_t c = 0; c < stride; c++) {
+      dst[c] = Lerp8(dst[c], src[c], weight);
+    }
+    dst += stride;
+    src += stride;
+  }
+}
+
+}  // namespace LightShow
@@ -0,0 +1,83 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_BLEND_H
+#define LIGHTSHOW_BLEND_H
+
+#include <Arduino.h>
+
+#include "LightShow.h"
+
+namespace LightShow {
+
+/**
+ * how a layer is combined with the layers below it
+ *
+ * Every mode is scaled by the layer's opacity, so an opacity of 0 leaves the
+ * layers below unchanged.
+ */
+enum class BlendMode : uint8_t {
+  /// the layer covers the layers below
+  Normal,
+  /// the layer is added to the layers below, saturating at 255
+  Add,
+  /// the layers below are multiplied by the layer, so black masks them out
+  Multiply,
+  /// each channel takes the brighter of the layer and the layers below
+  Max,
+  /// the layer covers the layers below in proportion to its per-pixel alpha
+  Alpha
+};
+
+/**
+ * blend a buffer of channel values into another
+ *
+ * Each loop is a plain, branch-free pass over bytes, so that compilers can
+ * vectorize it.  BlendMode::Alpha needs per-pixel alpha; use BlendAlpha().
+ * @param dst the layers below, len bytes long, overwritten with the result
+ * @param src the layer to blend in, len bytes long
+ * @param len the number of bytes to blend
+ * @param mode how to combine src with dst
+ * @param opacity how much of the blended result to keep, 0 to 255
+ */
+void BlendBuffer(uint8_t *dst, const uint8_t *src, size_t len, BlendMode mode,
+                 uint8_t opacity);
+
+/**
+ * blend a run of pixels into another in proportion to per-pixel alpha
+ * @param dst the layers below, count * stride bytes long, overwritten with the
+ * result
+ * @param src the layer to blend in, count * stride bytes long
+ * @param alpha the coverage of each pixel of src, 0 to 255, count bytes long
+ * @param count the number of pixels to blend
+ * @param stride the number of bytes per pixel
+ * @param opacity the coverage of the whole layer, 0 to 255
+ */
+void BlendAlpha(uint8_t *dst, const uint8_t *src, const uint8_t *alpha,
+                size_t count, uint8_t stride, uint8_t opacity);
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_BLEND_H
@@ -0,0 +1,218 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "Compositor.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <algorithm>
+#include <utility>
+
+namespace LightShow {
+
+namespace {
+
+/// the number of pixels blended through every layer at a time
+constexpr uint32_t kRunPixels = 32;
+
+}  // namespace
+
+Layer::Layer(uint32_t num, BlendMode mode, uint8_t opacity)
+    : pixels_(num),
+      alpha_(num, 0xFF),
+      fade_from_(num),
+      fade_to_(),
+      mode_(mode),
+      opacity_(opacity) {
+  this->CountAllocations(3);
+}
+
+Error Layer::BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) {
+  std::copy(this->pixels_.begin(), this->pixels_.end(),
+            this->fade_from_.begin());
+  this->fade_to_.r = r;
+  this->fade_to_.g = g;
+  this->fade_to_.b = b;
+  // a layer draws no current itself; the controller it is composed onto does
+  this->StartFade(fade_ms, 0);
+  return NoError;
+}
+
+Error Layer::BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                            uint32_t count) {
+  const uint32_t size = static_cast<uint32_t>(this->pixels_.size());
+  if (this->fade_target_.empty()) {
+    this->fade_target_.resize(size);
+    this->CountAllocations(1);
+  }
+  return this->StartCrossFade(fade_ms, this->pixels_.data(),
+                              this->fade_from_.data(),
+                              this->fade_target_.data(), size, target, count);
+}
+
+Error Layer::RenderFade(uint16_t weight) {
+  uint8_t *frame = reinterpret_cast<uint8_t *>(this->pixels_.data());
+  const uint8_t *from =
+      reinterpret_cast<const uint8_t *>(this->fade_from_.data());
+  const size_t len = this->pixels_.size() * sizeof(Pixel);
+  if (this->IsCrossFade()) {
+    LerpBuffer(frame, from,
+               reinterpret_cast<const uint8_t *>(this->fade_target_.data()),
+               len, weight);
+  } else {
+    LerpToColor(frame, from, len,
+                reinterpret_cast<const uint8_t *>(&this->fade_to_),
+                sizeof(Pixel), weight);
+  }
+  return this->Update();
+}
+
+Error Layer::EndFade() { return this->RenderFade(kLerpOne); }
+
+Error Layer::SetLEDs(uint8_t r, uint8_t g, uint8_t b) {
+  for (auto &item : this->pixels_) {
+    item.r = r;
+    item.g = g;
+    item.b = b;
+  }
+  this->TrackFrame(static_cast<uint32_t>(this->pixels_.size()) * (r + g + b));
+  return NoError;
+}
+
+Error Layer::SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) {
+  if (i >= this->pixels_.size()) {
+    return LEDIndexOutOfRange;
+  }
+  const Pixel &old = this->pixels_[i];
+  this->TrackPixel(old.r + old.g + old.b, r + g + b);
+  this->pixels_[i].r = r;
+  this->pixels_[i].g = g;
+  this->pixels_[i].b = b;
+  return NoError;
+}
+
+Error Layer::SetRange(uint32_t first, uint32_t count, uint8_t r, uint8_t g,
+                      uint8_t b) {
+  return this->FillRange(this->pixels_.data(), this->pixels_.size(), first,
+                         count, Pixel{r, g, b});
+}
+
+Error Layer::Blit(uint32_t first, const Pixel *src, uint32_t count) {
+  return this->BlitRange(this->pixels_.data(), this->pixels_.size(), first, src,
+                         count);
+}
+
+Error Layer::GetFrame(uint32_t first, Pixel *dst, uint32_t count) const {
+  return ReadRange(this->pixels_.data(), this->pixels_.size(), first, dst,
+                   count);
+}
+
+Error Layer::Transmit() {
+  this->changed_ = true;
+  return NoError;
+}
+
+void Layer::SetBlendMode(BlendMode mode) {
+  this->mode_ = mode;
+  this->changed_ = true;
+}
+
+void Layer::SetOpacity(uint8_t opacity) {
+  this->opacity_ = opacity;
+  this->changed_ = true;
+}
+
+void Layer::SetAlphas(uint8_t alpha) {
+  std::fill(this->alpha_.begin(), this->alpha_.end(), alpha);
+  this->changed_ = true;
+}
+
+Error Layer::SetAlpha(uint32_t i, uint8_t alpha) {
+  if (i >= this->alpha_.size()) {
+    return LEDIndexOutOfRange;
+  }
+  this->alpha_[i] = alpha;
+  this->changed_ = true;
+  return NoError;
+}
+
+const std::vector<Pixel> &Layer::GetPixels() const { return this->pixels_; }
+
+void Layer::BlendInto(Pixel *dst, uint32_t first, uint32_t count) const {
+  if (this->opacity_ == 0 || first >= this->pixels_.size()) {
+    return;
+  }
+  count = std::min<uint32_t>(count, this->pixels_.size() - first);
+
+  auto out = reinterpret_cast<uint8_t *>(dst);
+  auto src = reinterpret_cast<const uint8_t *>(this->pixels_.data() + first);
+  if (this->mode_ == BlendMode::Alpha) {
+    BlendAlpha(out, src, this->alpha_.data() + first, count, sizeof(Pixel),
+               this->opacity_);
+  } else {
+    BlendBuffer(out, src, count * sizeof(Pixel), this->mode_, this->opacity_);
+  }
+}
+
+Compositor::Compositor(std::shared_ptr<Controller> controller, uint32_t num)
+    : controller_(std::move(controller)), num_leds_(num) {}
+
+std::shared_ptr<Layer> Compositor::AddLayer(BlendMode mode, uint8_t opacity) {
+  auto layer = std::make_shared<Layer>(this->num_leds_, mode, opacity);
+  this->layers_.push_back(layer);
+  return layer;
+}
+
+Error Compositor::Update() {
+  for (const auto &layer : this->layers_) {
+    if (layer->changed_) {
+      return this->Compose();
+    }
+  }
+  return NoError;
+}
+
+Error Compositor::Compose() {
+  // blend every layer into one short run of pixels at a time, so that the run
+  // stays in cache and each output pixel is written once
+  Pixel run[kRunPixels];
+  for (uint32_t first = 0; first < this->num_leds_; first += kRunPixels) {
+    const uint32_t count = std::min(kRunPixels, this->num_leds_ - first);
+    memset(run, 0, sizeof(run));
+    for (const auto &layer : this->layers_) {
+      layer->BlendInto(run, first, count);
+    }
+    this->controller_->Blit(first, run, count);
+  }
+
+  for (const auto &layer : this->layers_) {
+    layer->changed_ = false;
+  }
+  return this->controller_->Update();
+}
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
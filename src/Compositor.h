@@ -0,0 +1,277 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_COMPOSITOR_H
+#define LIGHTSHOW_COMPOSITOR_H
+
+#include "LightShow.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <memory>
+#include <vector>
+
+#include "Blend.h"
+#include "Controller.h"
+#include "Pixel.h"
+
+namespace LightShow {
+
+/**
+ * an off-screen frame that a preset renders into
+ *
+ * A layer is a Controller, so any preset can draw into it.  Update() does not
+ * push anything; it marks the layer as changed, and the Compositor that owns
+ * the layer blends it into the strip on its next update.
+ */
+class Layer final : public Controller {
+ public:
+  /**
+   * Create a layer
+   * Layers are normally created with Compositor::AddLayer().
+   * @param num the number of led's in the layer
+   * @param mode how the layer is combined with the layers below it
+   * @param opacity how much the layer covers the layers below, 0 to 255
+   */
+  explicit Layer(uint32_t num, BlendMode mode = BlendMode::Normal,
+                 uint8_t opacity = 0xFF);
+
+  /**
+   * Begin fading to a color
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Begin crossfading to a frame
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param target the color to fade each LED to, count long
+   * @param count the number of LEDs in target
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                       uint32_t count) override;
+
+  /**
+   * Set all LEDs to a color
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetLEDs(uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Set a single LED to a color
+   * @param i the index of the LED to set (0-indexed)
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Set a run of LEDs to a color
+   * @param first the index of the first LED to set (0-indexed)
+   * @param count the number of LEDs to set
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetRange(uint32_t first, uint32_t count, uint8_t r, uint8_t g,
+                 uint8_t b) override;
+
+  /**
+   * Copy a run of pixels onto the LEDs
+   * @param first the index of the first LED to set (0-indexed)
+   * @param src the pixels to copy, count long
+   * @param count the number of pixels to copy
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Blit(uint32_t first, const Pixel *src, uint32_t count) override;
+
+  /**
+   * Read back a run of LEDs
+   * @param first the index of the first LED to read (0-indexed)
+   * @param dst where to copy the pixels, count long
+   * @param count the number of pixels to read
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error GetFrame(uint32_t first, Pixel *dst, uint32_t count) const override;
+
+  /**
+   * Set how the layer is combined with the layers below it
+   * @param mode the blend mode
+   */
+  void SetBlendMode(BlendMode mode);
+
+  /**
+   * Set how much the layer covers the layers below
+   * @param opacity 0 hides the layer, 255 applies it in full
+   */
+  void SetOpacity(uint8_t opacity);
+
+  /**
+   * Set the coverage of every pixel, used by BlendMode::Alpha
+   * @param alpha 0 is transparent, 255 is opaque
+   */
+  void SetAlphas(uint8_t alpha);
+
+  /**
+   * Set the coverage of a single pixel, used by BlendMode::Alpha
+   * @param i the index of the LED to set (0-indexed)
+   * @param alpha 0 is transparent, 255 is opaque
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetAlpha(uint32_t i, uint8_t alpha);
+
+  /**
+   * return the pixels of the layer
+   * @return the pixels, as they will next be blended
+   */
+  const std::vector<Pixel> &GetPixels() const;
+
+ protected:
+  /**
+   * mark the layer as changed, so that it is blended on the next compositor
+   * update
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Transmit() override;
+
+  friend class Compositor;
+
+  /**
+   * Blend part of the layer into a run of pixels
+   * @param dst the pixels below this layer, overwritten with the result
+   * @param first the index of the first pixel to blend
+   * @param count the number of pixels to blend
+   */
+  void BlendInto(Pixel *dst, uint32_t first, uint32_t count) const;
+
+  /**
+   * Render and push one frame of the running fade
+   * @param weight the progress made across the fade in Q8 fixed point, 0 to
+   * kLerpOne
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error RenderFade(uint16_t weight) override;
+
+  /**
+   * Set and push the fade target once the fade has completed
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error EndFade() override;
+
+  /// the pixels of the layer
+  std::vector<Pixel> pixels_;
+
+  /// the coverage of each pixel, used by BlendMode::Alpha
+  std::vector<uint8_t> alpha_;
+
+  /// a snapshot of the pixel values at the start of the running fade
+  std::vector<Pixel> fade_from_;
+
+  /// the color that the running fade is heading towards
+  Pixel fade_to_;
+
+  /// the frame that the running crossfade is heading towards, allocated by
+  /// the first crossfade
+  std::vector<Pixel> fade_target_;
+
+  /// how the layer is combined with the layers below it
+  BlendMode mode_;
+
+  /// how much the layer covers the layers below
+  uint8_t opacity_;
+
+  /// true if the layer has changed since it was last blended
+  bool changed_ = true;
+};
+
+/**
+ * blends several layers into a controller's frame
+ *
+ * Each preset renders into its own Layer.  Update() combines the layers,
+ * bottom first, and pushes the result to the controller.  The strip is worked
+ * through in short runs of pixels that stay in cache while every layer is
+ * blended into them, so the output is only written once per frame.
+ */
+class Compositor {
+ public:
+  /**
+   * Create a compositor
+   * @param controller the controller that shows the blended frame
+   * @param num the number of led's in the controller's strip
+   */
+  Compositor(std::shared_ptr<Controller> controller, uint32_t num);
+
+  /**
+   * Add a layer on top of the existing layers
+   * @param mode how the layer is combined with the layers below it
+   * @param opacity how much the layer covers the layers below, 0 to 255
+   * @return the new layer, to be passed to a preset as its controller
+   */
+  std::shared_ptr<Layer> AddLayer(BlendMode mode = BlendMode::Normal,
+                                  uint8_t opacity = 0xFF);
+
+  /**
+   * blend the layers and push the result, if any layer has changed
+   * Call this once from each pass through the sketch's loop(), after the
+   * presets.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Update();
+
+  /**
+   * blend the layers and push the result, whether or not they have changed
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Compose();
+
+ protected:
+  /// the controller that shows the blended frame
+  std::shared_ptr<Controller> controller_;
+
+  /// the number of led's in the controller's strip
+  uint32_t num_leds_;
+
+  /// the layers, bottom first
+  std::vector<std::shared_ptr<Layer>> layers_;
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
+
+#endif  // LIGHTSHOW_COMPOSITOR_H
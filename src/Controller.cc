@@ -25,45 +25,378 @@
 
 #include "Controller.h"
 
+#include <algorithm>
+
 namespace LightShow {
 
-Error Controller::Stop() { return this->Fade(0, 0, 0, 0); }
+namespace {
+
+/// fade to white
+const uint8_t kWhiteShow[] PROGMEM = {kShowFade, 0xFF, 0xFF, 0xFF, 0xE8, 0x03,
+                                      kShowEnd};
+
+/// fade to red
+const uint8_t kRedShow[] PROGMEM = {kShowFade, 0xFF, 0x00, 0x00, 0xE8, 0x03,
+                                    kShowEnd};
+
+/// fade to green
+const uint8_t kGreenShow[] PROGMEM = {kShowFade, 0x00, 0xFF, 0x00, 0xE8, 0x03,
+                                      kShowEnd};
+
+/// fade to blue
+const uint8_t kBlueShow[] PROGMEM = {kShowFade, 0x00, 0x00, 0xFF, 0xE8, 0x03,
+                                     kShowEnd};
+
+/// fade through red, green and blue, then out
+const uint8_t kCycleShow[] PROGMEM = {
+    kShowFade, 0xFF, 0x00, 0x00, 0xE8, 0x03,  // red over 1000ms
+    kShowFade, 0x00, 0xFF, 0x00, 0xE8, 0x03,  // green over 1000ms
+    kShowFade, 0x00, 0x00, 0xFF, 0xE8, 0x03,  // blue over 1000ms
+    kShowFade, 0x00, 0x00, 0x00, 0xE8, 0x03,  // black over 1000ms
+    kShowEnd};
+
+/// the scenes started by Controller::Start()
+const uint8_t *const kBuiltInShows[] = {kWhiteShow, kRedShow, kGreenShow,
+                                        kBlueShow, kCycleShow};
+
+}  // namespace
+
+Error Controller::Stop() {
+  this->show_.Stop();
+  return this->Fade(0, 0, 0, 0);
+}
 
 Error Controller::Stop(uint32_t fade_ms) {
+  this->show_.Stop();
   return this->Fade(fade_ms, 0, 0, 0);
 }
 
-int Controller::GetPresetCount() { return 5; }
+Error Controller::Fade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) {
+  auto e = this->BeginFade(fade_ms, r, g, b);
+  if (e != NoError) {
+    return e;
+  }
+  return this->AwaitFade();
+}
 
-Error Controller::Start(int preset) {
-  if (preset < 0 || preset > this->GetPresetCount()) {
-    return ShowIndexOutOfRange;
+Error Controller::CrossFade(uint32_t fade_ms, const Pixel *target,
+                            uint32_t count) {
+  auto e = this->BeginCrossFade(fade_ms, target, count);
+  if (e != NoError && e != LEDIndexOutOfRange) {
+    return e;
+  }
+  const auto awaited = this->AwaitFade();
+  return (awaited != NoError) ? awaited : e;
+}
+
+Error Controller::Loop() {
+  auto e = this->LoopFade();
+  if (e != NoError || !this->show_.IsPlaying()) {
+    return e;
+  }
+  return this->show_.Step(this);
+}
+
+Error Controller::Play(const uint8_t *program) {
+  this->show_.Play(program);
+  return this->show_.Step(this);
+}
+
+bool Controller::IsPlaying() const { return this->show_.IsPlaying(); }
+
+void Controller::SetShowPresets(Preset *const *presets, uint8_t count) {
+  this->show_.SetPresets(presets, count);
+}
+
+Error Controller::LoopFade() {
+  if (!this->fading_) {
+    return NoError;
+  }
+
+  const auto now = millis();
+  const auto elapsed = now - this->fade_start_;
+
+  // the fade is over, so land exactly on the target
+  if (elapsed >= this->fade_ms_) {
+    this->fading_ = false;
+    this->BeginRender();
+    this->TrackFrame(this->fade_to_sum_);
+    auto e = this->EndFade();
+    if (this->fade_callback_ != nullptr) {
+      this->fade_callback_(this);
+    }
+    return e;
+  }
+
+  // skip this call if the next frame is not due yet
+  if (now - this->fade_frame_time_ < this->frame_ms_) {
+    return NoError;
+  }
+  this->fade_frame_time_ = now;
+  this->BeginRender();
+
+  // determine the progress made across fade_ms as a fraction of kLerpOne,
+  // keeping the shifted value within 32 bits for very long fades
+  const uint32_t linear = elapsed < 0x1000000UL
+                              ? (elapsed << 8) / this->fade_ms_
+                              : elapsed / (this->fade_ms_ >> 8);
+
+  // ease the progress with a single lookup, leaving the pixels to the lerp
+  const uint32_t weight =
+      linear < kLerpOne ? pgm_read_byte(this->fade_curve_ + linear) : kLerpOne;
+
+  // every channel moves by the same fraction, so the sum of them does too
+  this->TrackFrame(static_cast<uint32_t>(
+      (static_cast<uint64_t>(this->fade_from_sum_) * (kLerpOne - weight) +
+       static_cast<uint64_t>(this->fade_to_sum_) * weight) >>
+      8));
+  return this->RenderFade(static_cast<uint16_t>(weight));
+}
+
+Error Controller::Update() {
+  // the frame is pushed once, by EndFrame()
+  if (this->holding_) {
+    this->push_held_ = true;
+    return NoError;
+  }
+
+  bool changed = false;
+  if (this->output_stage_ != nullptr) {
+    this->output_stage_->Prepare();
+    if (this->output_stage_->GetVersion() != this->output_version_) {
+      this->output_version_ = this->output_stage_->GetVersion();
+      changed = true;
+    }
+  }
+
+  // scale the driven part of the current down to whatever the budget leaves
+  // once every pixel's idle current is paid for
+  uint8_t scale = 0xFF;
+  const uint32_t estimate = this->GetPowerEstimate();
+  if (this->power_budget_ma_ != 0 && estimate > this->power_budget_ma_) {
+    const uint32_t idle = this->power_pixels_ * this->idle_ma_;
+    const uint32_t driven = estimate - idle;
+    if (this->power_budget_ma_ > idle) {
+      scale = static_cast<uint8_t>(
+          static_cast<uint64_t>(this->power_budget_ma_ - idle) * 0xFF /
+          driven);
+    } else {
+      scale = 0;
+    }
+  }
+  if (scale != this->power_scale_) {
+    this->power_scale_ = scale;
+    changed = true;
+  }
+  if (changed) {
+    this->OnOutputChanged();
+  }
+  this->pushed_version_ = this->frame_version_;
+
+#if LIGHTSHOW_STATS_ENABLE == 1
+  const uint32_t start = micros();
+  auto e = this->Transmit();
+  const uint32_t end = micros();
+
+  auto &stats = this->stats_;
+  stats.render_us = this->rendering_ ? start - this->render_start_us_ : 0;
+  stats.transmit_us = end - start;
+  if (stats.render_us > stats.max_render_us) {
+    stats.max_render_us = stats.render_us;
+  }
+  if (stats.transmit_us > stats.max_transmit_us) {
+    stats.max_transmit_us = stats.transmit_us;
+  }
+  this->rendering_ = false;
+
+  if (stats.frames > 0) {
+    stats.frame_us = start - this->last_frame_us_;
+    if (stats.frames == 1) {
+      stats.average_frame_us = stats.frame_us;
+    }
+
+    // file the difference from the average under the smallest bucket that
+    // holds it, then fold this interval into the average
+    const uint32_t average = stats.average_frame_us;
+    uint32_t jitter = (stats.frame_us > average) ? stats.frame_us - average
+                                                 : average - stats.frame_us;
+    uint8_t bucket = 0;
+    for (jitter /= kJitterBucketUs; jitter > 0 && bucket + 1 < kJitterBuckets;
+         jitter >>= 1) {
+      bucket++;
+    }
+    stats.jitter[bucket]++;
+    stats.average_frame_us =
+        average - (average >> 3) + (stats.frame_us >> 3);
+  }
+  this->last_frame_us_ = start;
+  stats.frames++;
+  return e;
+#else
+  return this->Transmit();
+#endif
+}
+
+#if LIGHTSHOW_STATS_ENABLE == 1
+const FrameStats &Controller::GetStats() const { return this->stats_; }
+
+void Controller::ResetStats() { this->stats_ = FrameStats(); }
+
+void Controller::PrintStats(Print &out) const {  // NOLINT(runtime/references)
+  this->stats_.PrintTo(out);
+}
+#endif
+
+bool Controller::IsFading() const { return this->fading_; }
+
+void Controller::SetFadeCallback(FadeCallback callback) {
+  this->fade_callback_ = callback;
+}
+
+void Controller::SetFrameInterval(uint32_t frame_ms) {
+  this->frame_ms_ = frame_ms;
+}
+
+void Controller::BeginFrame() {
+  this->holding_ = true;
+  this->push_held_ = false;
+}
+
+Error Controller::EndFrame() {
+  this->holding_ = false;
+  bool changed =
+      this->push_held_ || this->frame_version_ != this->pushed_version_;
+  if (this->output_stage_ != nullptr) {
+    this->output_stage_->Prepare();
+    changed |= this->output_stage_->GetVersion() != this->output_version_;
   }
+  this->push_held_ = false;
+  return changed ? this->Update() : NoError;
+}
+
+void Controller::SetFadeCurve(Curve curve) {
+  this->next_fade_curve_ = GetCurveTable(curve);
+}
 
-  switch (preset) {
-    case 0:
-      this->Fade(1000, 0xFF, 0xFF, 0xFF);
-      break;
-    case 1:
-      this->Fade(1000, 0xFF, 0x00, 0x00);
-      break;
-    case 2:
-      this->Fade(1000, 0x00, 0xFF, 0x00);
-      break;
-    case 3:
-      this->Fade(1000, 0x00, 0x00, 0xFF);
-      break;
-    case 4:
-      this->Fade(1000, 0xFF, 0x00, 0x00);
-      this->Fade(1000, 0x00, 0xFF, 0x00);
-      this->Fade(1000, 0x00, 0x00, 0xFF);
-      this->Fade(1000, 0x00, 0x00, 0x00);
-      break;
-    default:
-      return ShowUndefined;
+uint32_t Controller::GetAllocationCount() const { return this->allocations_; }
+
+Error Controller::ClipRange(uint32_t size, uint32_t *first, uint32_t *count) {
+  if (*first > size) {
+    *first = size;
+    *count = 0;
+    return LEDIndexOutOfRange;
+  }
+  if (*count > size - *first) {
+    *count = size - *first;
+    return LEDIndexOutOfRange;
   }
+  return NoError;
+}
+
+Error Controller::FillRange(Pixel *frame, uint32_t size, uint32_t first,
+                            uint32_t count, Pixel color) {
+  const Error e = ClipRange(size, &first, &count);
+  Pixel *run = frame + first;
+  this->TrackPixel(
+      SumBuffer(reinterpret_cast<const uint8_t *>(run), count * sizeof(Pixel)),
+      count * (color.r + color.g + color.b));
+  std::fill(run, run + count, color);
+  return e;
+}
+
+Error Controller::BlitRange(Pixel *frame, uint32_t size, uint32_t first,
+                            const Pixel *src, uint32_t count) {
+  const Error e = ClipRange(size, &first, &count);
+  Pixel *run = frame + first;
+  this->TrackPixel(
+      SumBuffer(reinterpret_cast<const uint8_t *>(run), count * sizeof(Pixel)),
+      SumBuffer(reinterpret_cast<const uint8_t *>(src), count * sizeof(Pixel)));
+  memmove(run, src, count * sizeof(Pixel));
+  return e;
+}
+
+Error Controller::ReadRange(const Pixel *frame, uint32_t size, uint32_t first,
+                            Pixel *dst, uint32_t count) {
+  const Error e = ClipRange(size, &first, &count);
+  memmove(dst, frame + first, count * sizeof(Pixel));
+  return e;
+}
+
+void Controller::CountAllocations(uint32_t count) {
+  this->allocations_ += count;
+}
 
+void Controller::SetOutputStage(OutputStage *stage) {
+  this->output_stage_ = stage;
+  this->output_version_ = 0;
+  this->OnOutputChanged();
+}
+
+Error Controller::SetPowerBudget(uint32_t milliamps) {
+  this->power_budget_ma_ = milliamps;
   return NoError;
 }
 
+void Controller::SetPowerModel(uint8_t channel_ma, uint8_t idle_ma) {
+  this->channel_ma_ = channel_ma;
+  this->idle_ma_ = idle_ma;
+}
+
+uint32_t Controller::GetPowerEstimate() const {
+  uint64_t driven =
+      static_cast<uint64_t>(this->power_sum_) * this->channel_ma_ / 0xFF;
+  if (this->output_stage_ != nullptr && this->IsStageApplied()) {
+    driven = driven * (this->output_stage_->GetBrightness() + 1) >> 8;
+  }
+  return static_cast<uint32_t>(driven) + this->power_pixels_ * this->idle_ma_;
+}
+
+uint8_t Controller::GetPowerScale() const { return this->power_scale_; }
+
+void Controller::StartFade(uint32_t fade_ms, uint32_t to_sum, bool cross) {
+  this->fade_from_sum_ = this->power_sum_;
+  this->fade_to_sum_ = to_sum;
+  this->fade_start_ = millis();
+  this->fade_ms_ = fade_ms;
+  // backdate the last frame so that the first call to Loop() renders
+  this->fade_frame_time_ = this->fade_start_ - this->frame_ms_;
+  this->fading_ = true;
+  this->cross_fade_ = cross;
+  this->fade_curve_ = this->next_fade_curve_;
+}
+
+Error Controller::StartCrossFade(uint32_t fade_ms, const Pixel *frame,
+                                 Pixel *from, Pixel *to, uint32_t size,
+                                 const Pixel *target, uint32_t count) {
+  uint32_t first = 0;
+  const Error e = ClipRange(size, &first, &count);
+  memmove(from, frame, size * sizeof(Pixel));
+  memmove(to, target, count * sizeof(Pixel));
+  memmove(to + count, frame + count, (size - count) * sizeof(Pixel));
+  this->StartFade(fade_ms, SumBuffer(reinterpret_cast<const uint8_t *>(to),
+                                     size * sizeof(Pixel)),
+                  true);
+  return e;
+}
+
+Error Controller::AwaitFade() {
+  Error e = NoError;
+  while (this->fading_ && e == NoError) {
+    e = this->LoopFade();
+  }
+  return e;
+}
+
+int Controller::GetPresetCount() {
+  return sizeof(kBuiltInShows) / sizeof(kBuiltInShows[0]);
+}
+
+Error Controller::Start(int preset) {
+  const int count = sizeof(kBuiltInShows) / sizeof(kBuiltInShows[0]);
+  if (preset < 0 || preset >= count) {
+    return ShowIndexOutOfRange;
+  }
+  return this->Play(kBuiltInShows[preset]);
+}
+
 }  // namespace LightShow
@@ -28,12 +28,26 @@
 
 #include <Arduino.h>
 
+#include "Curve.h"
 #include "Error.h"
+#include "Lerp.h"
 #include "LightShow.h"
+#include "OutputStage.h"
+#include "Pixel.h"
 #include "Preset.h"
+#include "Show.h"
+#include "Stats.h"
 
 namespace LightShow {
 
+class Controller;
+
+/**
+ * a function to be called when a non-blocking fade completes
+ * @param controller the controller that finished fading
+ */
+typedef void (*FadeCallback)(Controller *controller);
+
 class Controller {
  public:
   /**
@@ -52,6 +66,9 @@ class Controller {
 
   /**
    * Start a scene
+   * The built-in scenes are show programs, so this returns as soon as the
+   * scene has started; call Loop() to play it.  To run presets by index,
+   * register them with a LightShow::Scheduler instead.
    * @param preset the current_preset index of the scene to Start (0-indexed)
    * @return 0 on success or a LightShow::Error on error
    */
@@ -64,16 +81,188 @@ class Controller {
    */
   virtual int GetPresetCount();
 
+  /**
+   * Start playing a show program, replacing any running program
+   * This is a non-blocking operation.  Call Loop() to advance the program.
+   * @param program the program, in program memory; see LightShow::ShowOp
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Play(const uint8_t *program);
+
+  /**
+   * check whether a show program is running
+   * @return true if a program is running, else false
+   */
+  bool IsPlaying() const;
+
+  /**
+   * Set the presets that show programs can run with kShowCall
+   * @param presets the presets, indexed by the kShowCall operand
+   * @param count the number of presets
+   */
+  void SetShowPresets(Preset *const *presets, uint8_t count);
+
   /**
    * Fade to a color
-   * This is a blocking operation.
+   * This is a blocking operation.  The fade is started with BeginFade() and
+   * Loop() is called until it completes.
    * @param fade_ms the approximate number of milliseconds over which to fade
    * @param r Red brightness, 0 to 255.
    * @param g Green brightness, 0 to 255.
    * @param b Blue brightness, 0 to 255.
    * @return 0 on success or a LightShow::Error on error
    */
-  virtual Error Fade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) = 0;
+  virtual Error Fade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b);
+
+  /**
+   * Begin fading to a color
+   * This is a non-blocking operation.  The current LED values are captured as
+   * the starting point, and each call to Loop() renders the next frame of the
+   * fade.  Starting a fade while another is running replaces it.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  virtual Error BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g,
+                          uint8_t b) = 0;
+
+  /**
+   * Crossfade to a frame
+   * This is a blocking operation.  The crossfade is started with
+   * BeginCrossFade() and Loop() is called until it completes.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param target the color to fade each LED to, count long
+   * @param count the number of LEDs in target
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error CrossFade(uint32_t fade_ms, const Pixel *target, uint32_t count);
+
+  /**
+   * Begin crossfading to a frame
+   * This is a non-blocking operation, like BeginFade(), except that each LED
+   * fades towards its own color.  The target is copied into a buffer held by
+   * the controller, which is allocated by the first crossfade and then reused,
+   * so target need not outlive the call.  LEDs past the end of target keep
+   * their current color.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param target the color to fade each LED to, count long
+   * @param count the number of LEDs in target
+   * @return 0 on success, or LEDIndexOutOfRange if target is longer than the
+   * strip, in which case the LEDs that fit still fade
+   */
+  virtual Error BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                               uint32_t count) = 0;
+
+  /**
+   * Advance a running fade by at most one frame, then the show program
+   * This returns immediately if no fade or program is running, or if the frame
+   * interval has not yet elapsed since the last rendered frame.  Call it once
+   * from each pass through the sketch's loop().
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Loop();
+
+  /**
+   * check whether a fade started by BeginFade() is still running
+   * @return true if a fade is running, else false
+   */
+  bool IsFading() const;
+
+  /**
+   * Set a function to be called each time a fade completes
+   * @param callback the function to call, or nullptr to disable
+   */
+  void SetFadeCallback(FadeCallback callback);
+
+  /**
+   * Set the minimum time between rendered fade frames
+   * @param frame_ms the number of milliseconds between frames (0 renders a
+   * frame on every call to Loop())
+   */
+  void SetFrameInterval(uint32_t frame_ms);
+
+  /**
+   * Set the easing that fades and crossfades follow
+   * The curve maps the time elapsed across a fade to the progress made
+   * towards its target, so Curve::CubicInOut starts and ends gently.  It
+   * costs one table lookup per frame, and applies to fades started after
+   * this call.
+   * @param curve the easing to follow, Curve::Linear by default
+   */
+  void SetFadeCurve(Curve curve);
+
+  /**
+   * return how many buffers this controller has allocated
+   * This counts the frame, fade and output buffers that the controller
+   * allocates itself, most of them when it is created and the rest on first
+   * use.  It cannot see allocations made elsewhere, such as by a preset or a
+   * strip library, so it is not a check that rendering never allocates; on a
+   * host build, GetHeapAllocations() from extras/host counts every one.
+   * @return the number of buffers allocated so far
+   */
+  uint32_t GetAllocationCount() const;
+
+  /**
+   * Correct every frame on its way to the wire
+   * The correction is applied in the pass that copies the frame for the wire,
+   * so it costs no extra pass over the frame.  FastLED strips, which hand
+   * their frame to the wire without copying it, copy it into a second buffer
+   * while a stage is attached; in a no-heap build a FastLEDBackend strip has
+   * no such buffer, and its Update() returns OutputStageUnsupported.
+   * NeoPixelController in zero-copy mode has no copy pass, and ignores the
+   * stage.
+   * @param stage the gamma, white point and brightness to apply, which must
+   * outlive the controller, or nullptr for none
+   */
+  void SetOutputStage(OutputStage *stage);
+
+  /**
+   * Limit the current drawn by the strip
+   * When a frame would draw more than the budget, it is scaled down on its way
+   * to the wire until it fits.  The frame that presets draw into is left
+   * alone.  Like the output stage, this is applied in the pass that copies the
+   * frame for the wire, or by FastLED as it encodes the frame.
+   * NeoPixelController in zero-copy mode has neither, as its frame is the
+   * wire buffer, so it refuses any budget but 0.
+   * @param milliamps the most current the strip may draw, or 0 for no limit
+   * @return 0 on success, or PowerLimitUnsupported if the controller cannot
+   * limit its strip
+   */
+  virtual Error SetPowerBudget(uint32_t milliamps);
+
+  /**
+   * Describe how much current the LEDs draw
+   * @param channel_ma the current drawn by one channel at full brightness
+   * @param idle_ma the current drawn by each pixel when it is dark
+   */
+  void SetPowerModel(uint8_t channel_ma = 20, uint8_t idle_ma = 1);
+
+  /**
+   * return the current that the frame would draw without limiting
+   * This is kept up to date as pixels are set, so reading it is cheap.  The
+   * output stage brightness is taken into account when the stage reaches the
+   * wire, but not its gamma curve or white point, so the estimate errs high.
+   * @return the estimated current in milliamps
+   */
+  uint32_t GetPowerEstimate() const;
+
+  /**
+   * return a number that changes whenever the frame is written
+   * Every SetLED(), SetLEDs(), SetRange(), Blit() and fade frame changes it,
+   * so a preset can tell whether anything else has drawn over the LEDs since
+   * it last set them.  Writes made straight into a backend's buffer, such as
+   * through StaticController::GetPixels(), are not seen.
+   * @return the frame version
+   */
+  uint32_t GetFrameVersion() const { return this->frame_version_; }
+
+  /**
+   * return the scale applied to the last frame to keep it within the budget
+   * @return 255 if the frame was not limited, else the scale applied
+   */
+  uint8_t GetPowerScale() const;
 
   /**
    * Set all LEDs to a color
@@ -94,11 +283,367 @@ class Controller {
    */
   virtual Error SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) = 0;
 
+  /**
+   * Set a run of LEDs to a color
+   * The run is bounds-checked once, so this is much cheaper than calling
+   * SetLED() for each LED.
+   * @param first the index of the first LED to set (0-indexed)
+   * @param count the number of LEDs to set
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success, or LEDIndexOutOfRange if the run passes the end of
+   * the strip, in which case the LEDs that fit are still set
+   */
+  virtual Error SetRange(uint32_t first, uint32_t count, uint8_t r, uint8_t g,
+                         uint8_t b) = 0;
+
+  /**
+   * Copy a run of pixels onto the LEDs
+   * Renderers that draw a whole frame should push it with this rather than
+   * with SetLED(), so that they pay for one call per frame instead of one per
+   * pixel.
+   * @param first the index of the first LED to set (0-indexed)
+   * @param src the pixels to copy, count long
+   * @param count the number of pixels to copy
+   * @return 0 on success, or LEDIndexOutOfRange if the run passes the end of
+   * the strip, in which case the pixels that fit are still copied
+   */
+  virtual Error Blit(uint32_t first, const Pixel *src, uint32_t count) = 0;
+
+  /**
+   * Read back a run of LEDs
+   * This returns the frame as set, before any output stage or power limit.
+   * @param first the index of the first LED to read (0-indexed)
+   * @param dst where to copy the pixels, count long
+   * @param count the number of pixels to read
+   * @return 0 on success, or LEDIndexOutOfRange if the run passes the end of
+   * the strip, in which case the pixels that fit are still read
+   */
+  virtual Error GetFrame(uint32_t first, Pixel *dst, uint32_t count) const = 0;
+
   /**
    * reads the local pixel values and pushing them to the NeoPixel
    * @return 0 on success or a LightShow::Error on error
    */
-  virtual Error Update() = 0;
+  Error Update();
+
+  /**
+   * Mark the start of rendering a frame
+   * Presets call this at the start of Loop(), so that the time until the next
+   * Update() is recorded as render time.  This does nothing unless
+   * LIGHTSHOW_STATS_ENABLE is set.
+   */
+  void BeginRender() {
+#if LIGHTSHOW_STATS_ENABLE == 1
+    this->render_start_us_ = micros();
+    this->rendering_ = true;
+#endif
+  }
+
+  /**
+   * Hold back every push until EndFrame()
+   * Until then, Update() only notes that the frame needs pushing, so a frame
+   * built by a preset, a fade and a show step together reaches the strip
+   * once.  The Scheduler calls this at the start of each frame.  A blocking
+   * Fade() run before EndFrame() renders every step with its pushes held, so
+   * none of it is seen; use BeginFade() instead.
+   */
+  void BeginFrame();
+
+  /**
+   * End a frame started by BeginFrame(), pushing it once if it needs pushing
+   * The frame is pushed if Update() was called since BeginFrame(), or if the
+   * frame was written or the output stage changed since the last push;
+   * otherwise the strip already shows it.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error EndFrame();
+
+#if LIGHTSHOW_STATS_ENABLE == 1
+  /**
+   * return the timing of the frames pushed so far
+   * Only available when LIGHTSHOW_STATS_ENABLE is set.
+   * @return the frame statistics
+   */
+  const FrameStats &GetStats() const;
+
+  /**
+   * Discard the frame statistics recorded so far
+   */
+  void ResetStats();
+
+  /**
+   * Print the frame statistics in human-readable form
+   * @param out where to print, for example Serial
+   */
+  void PrintStats(Print &out) const;  // NOLINT(runtime/references)
+#endif
+
+ protected:
+  /**
+   * push the local pixel values to the strip
+   * Update() calls this, so that every backend is instrumented in one place.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  virtual Error Transmit() = 0;
+
+  /**
+   * return the output stage to apply while copying the frame for the wire
+   * @return the stage, or nullptr if there is none or it changes nothing
+   */
+  const OutputStage *GetOutputStage() const {
+    return (this->output_stage_ != nullptr &&
+            !this->output_stage_->IsIdentity())
+               ? this->output_stage_
+               : nullptr;
+  }
+
+  /**
+   * Handle a change to the output stage tables or the power scale
+   * Backends that only push pixels that have changed override this to push
+   * the whole frame next time, as every pixel's output may have changed.
+   */
+  virtual void OnOutputChanged() {}
+
+  /**
+   * check whether the output stage is applied on the way to the wire
+   * The power estimate only counts the stage's brightness if it is, so a
+   * controller that ignores the stage must say so, or its budget would be
+   * exceeded.
+   * @return true if the stage's brightness reaches the wire, else false
+   */
+  virtual bool IsStageApplied() const { return true; }
+
+  /**
+   * Record the number of pixels that draw idle current
+   * Backends that drive a strip call this when they are created.
+   * @param pixels the number of pixels in the strip
+   */
+  void TrackPower(uint32_t pixels) { this->power_pixels_ = pixels; }
+
+  /**
+   * Account for a change to some pixels in the power estimate and the frame
+   * version
+   * @param old_sum the sum of the pixels' channels before the change
+   * @param new_sum the sum of the pixels' channels after the change
+   */
+  void TrackPixel(uint32_t old_sum, uint32_t new_sum) {
+    this->power_sum_ += new_sum - old_sum;
+    this->frame_version_++;
+  }
+
+  /**
+   * Account for a change to the whole frame in the power estimate and the
+   * frame version
+   * @param sum the sum of every channel of every pixel
+   */
+  void TrackFrame(uint32_t sum) {
+    this->power_sum_ = sum;
+    this->frame_version_++;
+  }
+
+  /**
+   * Clip a run of pixels to the strip
+   * @param size the number of pixels in the strip
+   * @param first the index of the first pixel of the run, moved back to size
+   * if it is past the end
+   * @param count the number of pixels in the run, reduced to the number that
+   * fit
+   * @return 0 if the whole run fits, else LEDIndexOutOfRange
+   */
+  static Error ClipRange(uint32_t size, uint32_t *first, uint32_t *count);
+
+  /**
+   * Set a run of a frame of Pixels to a color, for SetRange()
+   * @param frame the pixels of the strip
+   * @param size the number of pixels in the strip
+   * @param first the index of the first pixel to set
+   * @param count the number of pixels to set
+   * @param color the color to set them to
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error FillRange(Pixel *frame, uint32_t size, uint32_t first, uint32_t count,
+                  Pixel color);
+
+  /**
+   * Copy a run of pixels into a frame of Pixels, for Blit()
+   * @param frame the pixels of the strip
+   * @param size the number of pixels in the strip
+   * @param first the index of the first pixel to set
+   * @param src the pixels to copy
+   * @param count the number of pixels to copy
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BlitRange(Pixel *frame, uint32_t size, uint32_t first,
+                  const Pixel *src, uint32_t count);
+
+  /**
+   * Copy a run of pixels out of a frame of Pixels, for GetFrame()
+   * @param frame the pixels of the strip
+   * @param size the number of pixels in the strip
+   * @param first the index of the first pixel to read
+   * @param dst where to copy the pixels
+   * @param count the number of pixels to read
+   * @return 0 on success or a LightShow::Error on error
+   */
+  static Error ReadRange(const Pixel *frame, uint32_t size, uint32_t first,
+                         Pixel *dst, uint32_t count);
+
+  /**
+   * Record buffers allocated by this controller
+   * @param count the number of buffers allocated
+   */
+  void CountAllocations(uint32_t count);
+
+  /**
+   * Record the timing of a new fade
+   * Backends call this from BeginFade() once the fade target is captured.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param to_sum the sum of every channel of every pixel at the fade target,
+   * so that the power estimate can follow the fade without a pass over it
+   * @param cross true if the fade heads to a frame rather than a color
+   */
+  void StartFade(uint32_t fade_ms, uint32_t to_sum, bool cross = false);
+
+  /**
+   * Record the timing of a new crossfade, and capture its endpoints
+   * Backends whose frame is an array of Pixels call this from
+   * BeginCrossFade().
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param frame the pixels of the strip
+   * @param from set to a copy of frame, size long
+   * @param to set to target, then the rest of frame, size long
+   * @param size the number of pixels in the strip
+   * @param target the color to fade each pixel to
+   * @param count the number of pixels in target
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error StartCrossFade(uint32_t fade_ms, const Pixel *frame, Pixel *from,
+                       Pixel *to, uint32_t size, const Pixel *target,
+                       uint32_t count);
+
+  /**
+   * check whether the running fade is a crossfade
+   * @return true if the fade was started by BeginCrossFade(), else false
+   */
+  bool IsCrossFade() const { return this->cross_fade_; }
+
+  /**
+   * Render and push one frame of the running fade
+   * @param weight the progress made across the fade in Q8 fixed point, 0 to
+   * kLerpOne
+   * @return 0 on success or a LightShow::Error on error
+   */
+  virtual Error RenderFade(uint16_t weight) = 0;
+
+  /**
+   * Set and push the fade target once the fade has completed
+   * @return 0 on success or a LightShow::Error on error
+   */
+  virtual Error EndFade() = 0;
+
+  /**
+   * Advance the running fade until it completes
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error AwaitFade();
+
+  /**
+   * Advance a running fade by at most one frame
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error LoopFade();
+
+ private:
+  /// the function to call when a fade completes
+  FadeCallback fade_callback_ = nullptr;
+
+  /// true while a fade started by BeginFade() is running
+  bool fading_ = false;
+
+  /// true if the running fade heads to a frame rather than a color
+  bool cross_fade_ = false;
+
+  /// true between BeginFrame() and EndFrame(), while pushes are held back
+  bool holding_ = false;
+
+  /// true if Update() was called while pushes were held back
+  bool push_held_ = false;
+
+  /// frame_version_ when the frame was last pushed
+  uint32_t pushed_version_ = 0;
+
+  /// the millis() time at which the running fade started
+  uint32_t fade_start_ = 0;
+
+  /// the duration of the running fade
+  uint32_t fade_ms_ = 0;
+
+  /// the millis() time at which the last fade frame was rendered
+  uint32_t fade_frame_time_ = 0;
+
+  /// the minimum number of milliseconds between fade frames
+  uint32_t frame_ms_ = 0;
+
+  /// the easing table that maps time elapsed to fade progress
+  const uint8_t *fade_curve_ = GetCurveTable(Curve::Linear);
+
+  /// the easing table for fades started after SetFadeCurve()
+  const uint8_t *next_fade_curve_ = GetCurveTable(Curve::Linear);
+
+  /// the number of buffers allocated by this controller
+  uint32_t allocations_ = 0;
+
+  /// the corrections applied on the way to the wire, or nullptr for none
+  OutputStage *output_stage_ = nullptr;
+
+  /// the version of output_stage_ that was last pushed
+  uint32_t output_version_ = 0;
+
+  /// the sum of every channel of every pixel in the frame
+  uint32_t power_sum_ = 0;
+
+  /// changed by every write to the frame
+  uint32_t frame_version_ = 0;
+
+  /// the number of pixels that draw idle current
+  uint32_t power_pixels_ = 0;
+
+  /// the sum of every channel at the start of the running fade
+  uint32_t fade_from_sum_ = 0;
+
+  /// the sum of every channel at the target of the running fade
+  uint32_t fade_to_sum_ = 0;
+
+  /// the most current the strip may draw, or 0 for no limit
+  uint32_t power_budget_ma_ = 0;
+
+  /// the current drawn by one channel at full brightness
+  uint8_t channel_ma_ = 20;
+
+  /// the current drawn by each dark pixel
+  uint8_t idle_ma_ = 1;
+
+  /// the scale applied to the last frame to keep it within the budget
+  uint8_t power_scale_ = 0xFF;
+
+  /// the interpreter for the running show program
+  ShowPlayer show_;
+
+#if LIGHTSHOW_STATS_ENABLE == 1
+  /// the timing of the frames pushed so far
+  FrameStats stats_{};
+
+  /// the micros() time at which the last frame was pushed
+  uint32_t last_frame_us_ = 0;
+
+  /// the micros() time passed to the last call to BeginRender()
+  uint32_t render_start_us_ = 0;
+
+  /// true if BeginRender() has been called since the last update
+  bool rendering_ = false;
+#endif
 };
 
 }  // namespace LightShow
@@ -0,0 +1,165 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "Curve.h"
+
+namespace LightShow {
+
+namespace {
+
+/// brightness rises in proportion to position
+struct LinearCurve {
+  static constexpr uint8_t At(size_t i) { return static_cast<uint8_t>(i); }
+};
+
+/// brightness follows position ^ 2.2
+struct Gamma22Curve {
+  static constexpr uint8_t At(size_t i) {
+    return internal::ToByte(internal::Pow(i / 255.0, 2.2));
+  }
+};
+
+/// brightness follows (1 - cos(pi * position)) / 2
+struct SineCurve {
+  static constexpr uint8_t At(size_t i) {
+    return internal::ToByte(internal::Sin(internal::kPi * i / 510.0) *
+                            internal::Sin(internal::kPi * i / 510.0));
+  }
+};
+
+/**
+ * an easing curve that starts slowly
+ * @tparam Ease a type with a constexpr static F(double) that maps 0.0-1.0
+ * onto 0.0-1.0, starting slowly
+ */
+template <class Ease>
+struct EaseIn {
+  static constexpr uint8_t At(size_t i) {
+    return internal::ToByte(Ease::F(i / 255.0));
+  }
+};
+
+/**
+ * the mirror image of EaseIn, which finishes slowly
+ * @tparam Ease as for EaseIn
+ */
+template <class Ease>
+struct EaseOut {
+  static constexpr uint8_t At(size_t i) {
+    return internal::ToByte(1.0 - Ease::F(1.0 - i / 255.0));
+  }
+};
+
+/**
+ * EaseIn squeezed into the first half, then EaseOut into the second
+ * @tparam Ease as for EaseIn
+ */
+template <class Ease>
+struct EaseInOut {
+  static constexpr uint8_t At(size_t i) {
+    return internal::ToByte(i < 128 ? Ease::F(i / 127.5) / 2.0
+                                    : 1.0 - Ease::F(2.0 - i / 127.5) / 2.0);
+  }
+};
+
+/// position ^ 2
+struct Quad {
+  static constexpr double F(double x) { return x * x; }
+};
+
+/// position ^ 3
+struct Cubic {
+  static constexpr double F(double x) { return x * x * x; }
+};
+
+/// 1 - cos(pi / 2 * position), written as 2 * sin(pi / 4 * position) ^ 2
+struct SineQuarter {
+  static constexpr double F(double x) {
+    return 2.0 * internal::Sin(internal::kPi / 4.0 * x) *
+           internal::Sin(internal::kPi / 4.0 * x);
+  }
+};
+
+/// (2 ^ (8 * position) - 1) / 255
+struct Expo {
+  static constexpr double F(double x) {
+    return (internal::Exp(internal::kLn2 * 8.0 * x) - 1.0) / 255.0;
+  }
+};
+
+/// a parabola of height h, centred on c, that reaches 1.0 at its peak
+constexpr double BounceArc(double x, double c, double h) {
+  return 7.5625 * (x - c) * (x - c) + 1.0 - h;
+}
+
+/// a ball dropped at position 0 that lands at position 1 and bounces back
+/// three times, each bounce a quarter the height of the last
+struct BounceCurve {
+  static constexpr uint8_t At(size_t i) {
+    return internal::ToByte(
+        i < 93    ? 7.5625 * (i / 255.0) * (i / 255.0)
+        : i < 186 ? BounceArc(i / 255.0, 1.5 / 2.75, 0.25)
+        : i < 232 ? BounceArc(i / 255.0, 2.25 / 2.75, 0.0625)
+                  : BounceArc(i / 255.0, 2.625 / 2.75, 0.015625));
+  }
+};
+
+}  // namespace
+
+const uint8_t *GetCurveTable(Curve curve) {
+  switch (curve) {
+    case Curve::Gamma22:
+      return internal::Table<Gamma22Curve>::kValues;
+    case Curve::Sine:
+      return internal::Table<SineCurve>::kValues;
+    case Curve::Exponential:
+      return internal::Table<EaseIn<Expo>>::kValues;
+    case Curve::QuadIn:
+      return internal::Table<EaseIn<Quad>>::kValues;
+    case Curve::QuadOut:
+      return internal::Table<EaseOut<Quad>>::kValues;
+    case Curve::QuadInOut:
+      return internal::Table<EaseInOut<Quad>>::kValues;
+    case Curve::CubicIn:
+      return internal::Table<EaseIn<Cubic>>::kValues;
+    case Curve::CubicOut:
+      return internal::Table<EaseOut<Cubic>>::kValues;
+    case Curve::CubicInOut:
+      return internal::Table<EaseInOut<Cubic>>::kValues;
+    case Curve::SineIn:
+      return internal::Table<EaseIn<SineQuarter>>::kValues;
+    case Curve::SineOut:
+      return internal::Table<EaseOut<SineQuarter>>::kValues;
+    case Curve::ExponentialOut:
+      return internal::Table<EaseOut<Expo>>::kValues;
+    case Curve::Bounce:
+      return internal::Table<BounceCurve>::kValues;
+    case Curve::Linear:
+    default:
+      return internal::Table<LinearCurve>::kValues;
+  }
+}
+
+}  // namespace LightShow
@@ -0,0 +1,237 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_CURVE_H
+#define LIGHTSHOW_CURVE_H
+
+#include <Arduino.h>
+
+#include "LightShow.h"
+
+namespace LightShow {
+
+/**
+ * the shape of a brightness ramp, or the easing of a fade
+ *
+ * Each curve is stored as a 256-entry table in program memory, generated at
+ * compile time, that maps a linear position (0-255) to a brightness (0-255).
+ * Curves ending in In start slowly, those ending in Out finish slowly, and
+ * those ending in InOut do both.
+ */
+enum class Curve : uint8_t {
+  /// brightness rises in proportion to position
+  Linear,
+  /// brightness follows position ^ 2.2, which looks even to the eye
+  Gamma22,
+  /// brightness follows half a cosine wave, easing in and out of each end
+  Sine,
+  /// brightness doubles every 1/8 of the way, like 2 ^ (8 * position) - 1
+  Exponential,
+  /// brightness follows position ^ 2
+  QuadIn,
+  /// the mirror image of QuadIn
+  QuadOut,
+  /// QuadIn for the first half, then QuadOut
+  QuadInOut,
+  /// brightness follows position ^ 3
+  CubicIn,
+  /// the mirror image of CubicIn
+  CubicOut,
+  /// CubicIn for the first half, then CubicOut
+  CubicInOut,
+  /// brightness follows the first quarter of a cosine wave
+  SineIn,
+  /// brightness follows the first quarter of a sine wave
+  SineOut,
+  /// the mirror image of Exponential
+  ExponentialOut,
+  /// brightness reaches full, then dips and returns three times, like a
+  /// dropped ball coming to rest
+  Bounce
+};
+
+/**
+ * return the table for a curve
+ * @param curve the curve to look up
+ * @return a 256-entry table in program memory; read it with pgm_read_byte()
+ */
+const uint8_t *GetCurveTable(Curve curve);
+
+/**
+ * look up a value in a curve
+ * @param curve the curve to apply
+ * @param position the linear position, 0 to 255
+ * @return the brightness at position, 0 to 255
+ */
+inline uint8_t ApplyCurve(Curve curve, uint8_t position) {
+  return pgm_read_byte(GetCurveTable(curve) + position);
+}
+
+namespace internal {
+
+/// pi, to double precision
+constexpr double kPi = 3.14159265358979323846;
+
+/// the natural log of 2, to double precision
+constexpr double kLn2 = 0.69314718055994530942;
+
+/**
+ * sum the Taylor series of e^x, for small x
+ * @param x the exponent
+ * @param term the current term of the series
+ * @param n the index of the current term
+ * @return the remaining sum of the series
+ */
+constexpr double ExpSeries(double x, double term, int n) {
+  return n > 16 ? term : term + ExpSeries(x, term * x / n, n + 1);
+}
+
+/**
+ * square a value repeatedly
+ * @param v the value to square
+ * @param times the number of times to square it
+ * @return v ^ (2 ^ times)
+ */
+constexpr double SquareTimes(double v, int times) {
+  return times == 0 ? v : SquareTimes(v * v, times - 1);
+}
+
+/**
+ * compute e^x at compile time
+ * The argument is divided by 1024 so the series converges quickly, and the
+ * result is squared back up.
+ * @param x the exponent
+ * @return e^x
+ */
+constexpr double Exp(double x) {
+  return SquareTimes(ExpSeries(x / 1024.0, 1.0, 1), 10);
+}
+
+/**
+ * sum the series ln(m) = 2 * (y + y^3/3 + y^5/5 + ...), y = (m-1)/(m+1)
+ * @param y2 y squared
+ * @param power the current odd power of y
+ * @param n the current odd divisor
+ * @return the remaining sum of the series
+ */
+constexpr double LogSeries(double y2, double power, int n) {
+  return n > 61 ? 0.0 : power / n + LogSeries(y2, power * y2, n + 2);
+}
+
+/**
+ * compute ln(x) at compile time
+ * x is scaled into [1, 2) by powers of two so the series converges quickly.
+ * @param x a positive value
+ * @return ln(x)
+ */
+constexpr double Log(double x) {
+  return x < 1.0   ? Log(x * 2.0) - kLn2
+         : x >= 2.0 ? Log(x / 2.0) + kLn2
+                    : 2.0 * LogSeries(((x - 1.0) / (x + 1.0)) *
+                                          ((x - 1.0) / (x + 1.0)),
+                                      (x - 1.0) / (x + 1.0), 1);
+}
+
+/**
+ * compute x^p at compile time
+ * @param x a value of 0 or more
+ * @param p the exponent
+ * @return x^p
+ */
+constexpr double Pow(double x, double p) {
+  return x <= 0.0 ? 0.0 : Exp(p * Log(x));
+}
+
+/**
+ * sum the Taylor series of sin(x)
+ * @param x2 x squared
+ * @param term the current term of the series
+ * @param n the power of x in the current term
+ * @return the remaining sum of the series
+ */
+constexpr double SinSeries(double x2, double term, int n) {
+  return n > 41 ? term
+                : term + SinSeries(x2, -term * x2 / ((n + 1) * (n + 2)), n + 2);
+}
+
+/**
+ * compute sin(x) at compile time, for x from -pi to pi
+ * @param x the angle in radians
+ * @return sin(x)
+ */
+constexpr double Sin(double x) { return SinSeries(x * x, x, 1); }
+
+/**
+ * round a value from 0.0 to 1.0 onto a byte
+ * @param v the value to round
+ * @return v * 255, rounded to the nearest whole number
+ */
+constexpr uint8_t ToByte(double v) {
+  return v <= 0.0 ? 0 : v >= 1.0 ? 255 : static_cast<uint8_t>(v * 255.0 + 0.5);
+}
+
+/// a list of indexes, used to expand a table at compile time
+template <size_t... I>
+struct IndexList {};
+
+/// build an IndexList of 0 to N - 1
+template <size_t N, size_t... I>
+struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+
+/// build an IndexList of 0 to N - 1
+template <size_t... I>
+struct MakeIndexList<0, I...> {
+  /// the list of indexes
+  typedef IndexList<I...> type;
+};
+
+/**
+ * a table whose entries are computed at compile time
+ * @tparam F a type with a constexpr static At(size_t) returning each entry
+ * @tparam Indexes the IndexList of entries to compute
+ */
+template <class F, class Indexes = typename MakeIndexList<256>::type>
+struct Table;
+
+/**
+ * a table whose entries are computed at compile time
+ * @tparam F a type with a constexpr static At(size_t) returning each entry
+ * @tparam I the indexes of the entries to compute
+ */
+template <class F, size_t... I>
+struct Table<F, IndexList<I...>> {
+  /// the entries of the table, in program memory
+  static const uint8_t kValues[sizeof...(I)];
+};
+
+template <class F, size_t... I>
+const uint8_t Table<F, IndexList<I...>>::kValues[sizeof...(I)] PROGMEM = {
+    F::At(I)...};
+
+}  // namespace internal
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_CURVE_H
@@ -0,0 +1,173 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "DoubleBufferedController.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <algorithm>
+
+namespace LightShow {
+
+DoubleBufferedController::DoubleBufferedController(uint32_t num,
+                                                   Transport *transport)
+    : back_(num), front_(num), fade_from_(num), fade_to_(),
+      transport_(transport) {
+  this->CountAllocations(3);
+  this->TrackPower(num);
+}
+
+DoubleBufferedController::~DoubleBufferedController() { this->Flush(); }
+
+Error DoubleBufferedController::BeginFade(uint32_t fade_ms, uint8_t r,
+                                          uint8_t g, uint8_t b) {
+  std::copy(this->back_.begin(), this->back_.end(), this->fade_from_.begin());
+  this->fade_to_.r = r;
+  this->fade_to_.g = g;
+  this->fade_to_.b = b;
+  this->StartFade(fade_ms,
+                  static_cast<uint32_t>(this->back_.size()) * (r + g + b));
+  return NoError;
+}
+
+Error DoubleBufferedController::BeginCrossFade(uint32_t fade_ms,
+                                               const Pixel *target,
+                                               uint32_t count) {
+  const uint32_t size = static_cast<uint32_t>(this->back_.size());
+  if (this->fade_target_.empty()) {
+    this->fade_target_.resize(size);
+    this->CountAllocations(1);
+  }
+  return this->StartCrossFade(fade_ms, this->back_.data(),
+                              this->fade_from_.data(),
+                              this->fade_target_.data(), size, target, count);
+}
+
+Error DoubleBufferedController::RenderFade(uint16_t weight) {
+  uint8_t *frame = reinterpret_cast<uint8_t *>(this->back_.data());
+  const uint8_t *from =
+      reinterpret_cast<const uint8_t *>(this->fade_from_.data());
+  const size_t len = this->back_.size() * sizeof(Pixel);
+  if (this->IsCrossFade()) {
+    LerpBuffer(frame, from,
+               reinterpret_cast<const uint8_t *>(this->fade_target_.data()),
+               len, weight);
+  } else {
+    LerpToColor(frame, from, len,
+                reinterpret_cast<const uint8_t *>(&this->fade_to_),
+                sizeof(Pixel), weight);
+  }
+  return this->Update();
+}
+
+Error DoubleBufferedController::EndFade() {
+  return this->RenderFade(kLerpOne);
+}
+
+Error DoubleBufferedController::SetLEDs(uint8_t r, uint8_t g, uint8_t b) {
+  for (auto &item : this->back_) {
+    item.r = r;
+    item.g = g;
+    item.b = b;
+  }
+  this->TrackFrame(static_cast<uint32_t>(this->back_.size()) * (r + g + b));
+  return NoError;
+}
+
+Error DoubleBufferedController::SetLED(uint32_t i, uint8_t r, uint8_t g,
+                                       uint8_t b) {
+  if (i >= this->back_.size()) {
+    return LEDIndexOutOfRange;
+  }
+  const Pixel &old = this->back_[i];
+  this->TrackPixel(old.r + old.g + old.b, r + g + b);
+  this->back_[i].r = r;
+  this->back_[i].g = g;
+  this->back_[i].b = b;
+  return NoError;
+}
+
+Error DoubleBufferedController::SetRange(uint32_t first, uint32_t count,
+                                         uint8_t r, uint8_t g, uint8_t b) {
+  return this->FillRange(this->back_.data(), this->back_.size(), first, count,
+                         Pixel{r, g, b});
+}
+
+Error DoubleBufferedController::Blit(uint32_t first, const Pixel *src,
+                                     uint32_t count) {
+  return this->BlitRange(this->back_.data(), this->back_.size(), first, src,
+                         count);
+}
+
+Error DoubleBufferedController::GetFrame(uint32_t first, Pixel *dst,
+                                         uint32_t count) const {
+  return ReadRange(this->back_.data(), this->back_.size(), first, dst, count);
+}
+
+void DoubleBufferedController::Flush() {
+  if (this->begun_) {
+    this->transport_->Wait();
+  }
+}
+
+uint32_t DoubleBufferedController::GetWaitTime() const {
+  return this->wait_us_;
+}
+
+Error DoubleBufferedController::Transmit() {
+  const auto count = static_cast<uint32_t>(this->front_.size());
+  if (!this->begun_) {
+    auto e = this->transport_->Begin(this->front_.data(), count);
+    if (e != NoError) {
+      return e;
+    }
+    this->begun_ = true;
+  }
+
+  // the front buffer belongs to the transport until the last frame is sent;
+  // the back buffer keeps its pixels, as presets may only change some of them
+  const uint32_t start = micros();
+  this->transport_->Wait();
+  this->wait_us_ = micros() - start;
+  const OutputStage *stage = this->GetOutputStage();
+  const uint8_t scale = this->GetPowerScale();
+  auto *front = reinterpret_cast<uint8_t *>(this->front_.data());
+  if (stage != nullptr) {
+    stage->Apply(this->back_.data(), this->front_.data(), count);
+    if (scale != 0xFF) {
+      ScaleBuffer(front, front, count * sizeof(Pixel), scale);
+    }
+  } else if (scale != 0xFF) {
+    ScaleBuffer(front, reinterpret_cast<const uint8_t *>(this->back_.data()),
+                count * sizeof(Pixel), scale);
+  } else {
+    std::copy(this->back_.begin(), this->back_.end(), this->front_.begin());
+  }
+  return this->transport_->Send(this->front_.data(), count);
+}
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
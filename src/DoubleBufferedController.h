@@ -0,0 +1,201 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_DOUBLEBUFFEREDCONTROLLER_H
+#define LIGHTSHOW_DOUBLEBUFFEREDCONTROLLER_H
+
+#include "LightShow.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <vector>
+
+#include "Controller.h"
+#include "Pixel.h"
+#include "Transport.h"
+
+namespace LightShow {
+
+/**
+ * a controller that renders the next frame while the last one is sent
+ *
+ * Presets draw into a back buffer.  Update() copies it to a front buffer and
+ * hands the front buffer to the transport, then returns, so that the next
+ * frame can be rendered while this one goes out on the wire.  With a transport
+ * that sends in the background, a frame then costs the longer of rendering
+ * and sending it, instead of both.  Update() only waits if the previous frame
+ * is still being sent, and GetWaitTime() reports how long it waited.  The
+ * only transport for a board, BackendTransport, blocks, so there the overlap
+ * waits on a background transport for the platform.
+ */
+class DoubleBufferedController final : public Controller {
+ public:
+  /**
+   * Create a double-buffered controller
+   * @param num the number of led's in the strip
+   * @param transport the link that sends frames to the strip, which must
+   * outlive the controller
+   */
+  DoubleBufferedController(uint32_t num, Transport *transport);
+
+  /**
+   * Wait for the last frame to be sent, as it is sent from this controller
+   */
+  ~DoubleBufferedController();
+
+  /**
+   * Begin fading to a color
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Begin crossfading to a frame
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param target the color to fade each LED to, count long
+   * @param count the number of LEDs in target
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                       uint32_t count) override;
+
+  /**
+   * Set all LEDs to a color
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetLEDs(uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Set a single LED to a color
+   * @param i the index of the LED to set (0-indexed)
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Set a run of LEDs to a color
+   * @param first the index of the first LED to set (0-indexed)
+   * @param count the number of LEDs to set
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetRange(uint32_t first, uint32_t count, uint8_t r, uint8_t g,
+                 uint8_t b) override;
+
+  /**
+   * Copy a run of pixels onto the LEDs
+   * @param first the index of the first LED to set (0-indexed)
+   * @param src the pixels to copy, count long
+   * @param count the number of pixels to copy
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Blit(uint32_t first, const Pixel *src, uint32_t count) override;
+
+  /**
+   * Read back a run of LEDs
+   * @param first the index of the first LED to read (0-indexed)
+   * @param dst where to copy the pixels, count long
+   * @param count the number of pixels to read
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error GetFrame(uint32_t first, Pixel *dst, uint32_t count) const override;
+
+  /**
+   * Block until the last frame has been sent
+   */
+  void Flush();
+
+  /**
+   * return how long the last update waited for the frame before it to be sent
+   * @return the time in microseconds
+   */
+  uint32_t GetWaitTime() const;
+
+ protected:
+  /**
+   * hand the back buffer to the transport, once it is free
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Transmit() override;
+
+  /**
+   * Render and push one frame of the running fade
+   * @param weight the progress made across the fade in Q8 fixed point, 0 to
+   * kLerpOne
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error RenderFade(uint16_t weight) override;
+
+  /**
+   * Set and push the fade target once the fade has completed
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error EndFade() override;
+
+  /// the frame that presets draw into
+  std::vector<Pixel> back_;
+
+  /// the frame being sent
+  std::vector<Pixel> front_;
+
+  /// a snapshot of back_ at the start of the running fade
+  std::vector<Pixel> fade_from_;
+
+  /// the color that the running fade is heading towards
+  Pixel fade_to_;
+
+  /// the frame that the running crossfade is heading towards, allocated by
+  /// the first crossfade
+  std::vector<Pixel> fade_target_;
+
+  /// the link that sends frames to the strip
+  Transport *transport_;
+
+  /// true once the transport has been started
+  bool begun_ = false;
+
+  /// the time the last update spent waiting for the transport
+  uint32_t wait_us_ = 0;
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
+
+#endif  // LIGHTSHOW_DOUBLEBUFFEREDCONTROLLER_H
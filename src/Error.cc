@@ -25,22 +25,64 @@
 
 #include "Error.h"
 
+#include <Arduino.h>
+
 namespace LightShow {
 
-std::string DescribeError(Error e) {
+namespace {
+
+/// the descriptions of each error code, in program memory
+const char kNoError[] PROGMEM = "No Error";
+const char kNoLEDStripConnected[] PROGMEM =
+    "An LED Strip has not been connected to the show";
+const char kShowIndexOutOfRange[] PROGMEM =
+    "The show referenced by index does not exist";
+const char kShowUndefined[] PROGMEM =
+    "The show referenced by index exists, but is not defined";
+const char kLEDIndexOutOfRange[] PROGMEM =
+    "The LED referenced by index does not exist";
+const char kShowFileInvalid[] PROGMEM = "The recorded show could not be read";
+const char kPowerLimitUnsupported[] PROGMEM =
+    "The controller cannot limit the current drawn by its strip";
+const char kOutputStageUnsupported[] PROGMEM =
+    "The strip cannot apply the output stage";
+const char kCrossFadeUnsupported[] PROGMEM =
+    "The controller was built without room for a crossfade target";
+const char kUnknownError[] PROGMEM = "Unknown error";
+
+}  // namespace
+
+const char *DescribeErrorP(Error e) {
   switch (e) {
     case NoError:
-      return "No Error";
+      return kNoError;
     case NoLEDStripConnected:
-      return "An LED Strip has not been connected to the show";
+      return kNoLEDStripConnected;
     case ShowIndexOutOfRange:
-      return "The show referenced by index does not exist";
+      return kShowIndexOutOfRange;
     case ShowUndefined:
-      return "The show referenced by index exists, but is not defined";
+      return kShowUndefined;
     case LEDIndexOutOfRange:
-      return "The LED referenced by index does not exist";
+      return kLEDIndexOutOfRange;
+    case ShowFileInvalid:
+      return kShowFileInvalid;
+    case PowerLimitUnsupported:
+      return kPowerLimitUnsupported;
+    case OutputStageUnsupported:
+      return kOutputStageUnsupported;
+    case CrossFadeUnsupported:
+      return kCrossFadeUnsupported;
   }
-  return "Unknown error";
+  return kUnknownError;
+}
+
+#if LIGHTSHOW_NO_HEAP != 1
+std::string DescribeError(Error e) {
+  const char *text = DescribeErrorP(e);
+  std::string description(strlen_P(text), '\0');
+  memcpy_P(&description[0], text, description.size());
+  return description;
 }
+#endif
 
 }  // namespace LightShow
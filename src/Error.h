@@ -26,7 +26,11 @@
 #ifndef LIGHTSHOW_ERROR_H
 #define LIGHTSHOW_ERROR_H
 
+#include "LightShow.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
 #include <string>
+#endif
 
 namespace LightShow {
 
@@ -41,15 +45,34 @@ enum Error : int {
   /// The show referenced by index exists, but is not defined
   ShowUndefined = 0x0004,
   /// The LED referenced by index does not exist
-  LEDIndexOutOfRange = 0x0008
+  LEDIndexOutOfRange = 0x0008,
+  /// A recorded show could not be read, or is not in the expected format
+  ShowFileInvalid = 0x0010,
+  /// The controller cannot limit the current drawn by its strip
+  PowerLimitUnsupported = 0x0020,
+  /// The strip cannot apply the output stage, so it was sent uncorrected
+  OutputStageUnsupported = 0x0040,
+  /// The controller was built without room for the target of a crossfade
+  CrossFadeUnsupported = 0x0080
 };
 
+/**
+ * describe an error code without allocating
+ * The description is kept in program memory.  On AVR, read it with the _P
+ * string functions, or print it by casting it to const __FlashStringHelper *.
+ * @param e an error code
+ * @return a description of the indicated error, in program memory
+ */
+const char *DescribeErrorP(Error e);
+
+#if LIGHTSHOW_NO_HEAP != 1
 /**
  * describe an error code
  * @param e an error code
  * @return a description of the indicated error
  */
 std::string DescribeError(Error e);
+#endif
 
 }  // namespace LightShow
 
@@ -25,55 +25,99 @@
 
 #include "FastLEDController.h"
 
-#if LIGHTSHOW_FASTLED_ENABLE == 1
+#if LIGHTSHOW_FASTLED_ENABLE == 1 && LIGHTSHOW_NO_HEAP != 1
 
 namespace LightShow {
 
 FastLEDController::FastLEDController(uint32_t num) {
   this->num_leds_ = num;
+  this->TrackPower(num);
   this->leds_ = new CRGB[num]{0};
+  this->CountAllocations(1);
+  this->fade_from_ = new CRGB[num];
+  this->CountAllocations(1);
   this->controller_ = &FastLED.addLeds<NEOPIXEL, LIGHTSHOW_FASTLED_DATA_PIN>(
       this->leds_, static_cast<int>(num));
 }
 
-FastLEDController::~FastLEDController() { this->Stop(); }
+FastLEDController::~FastLEDController() {
+  this->Stop();
+  delete[] this->fade_from_;
+  delete[] this->fade_target_;
+  delete[] this->out_;
+}
 
 Error FastLEDController::Fade(uint32_t fade_ms, CRGB c) {
-  const auto start_time = millis();
-  auto now = start_time;
-
-  CRGB *orig = new CRGB[this->num_leds_];
-  memcpy(orig, this->leds_, this->num_leds_ * sizeof(CRGB));
-
-  // progressively inch the neopixel_ strip closer to the target value
-  do {
-    // determine the percentage of progress made across fade_ms 0.0-1.0
-    auto scale =
-        static_cast<float>(now - start_time) / static_cast<float>(fade_ms);
-
-    // for each pixel, set it to some approximate value between starting and
-    // ending values in proportion to the calculated scale
-    for (uint32_t i = 0; i < this->num_leds_; i++) {
-      this->SetLED(
-          i,
-          orig[i].r + (uint8_t)((static_cast<float>(c.r - orig[i].r) * scale)),
-          orig[i].g + (uint8_t)((static_cast<float>(c.g - orig[i].g) * scale)),
-          orig[i].b + (uint8_t)((static_cast<float>(c.b - orig[i].b) * scale)));
-    }
-    this->Update();
-
-    // recalculate the current time, and keep going until we hit our target
-    // fade_ms
-  } while ((now = millis()) < start_time + fade_ms);
+  auto e = this->BeginFade(fade_ms, c);
+  if (e != NoError) {
+    return e;
+  }
+  return this->AwaitFade();
+}
 
-  // update our local neopixel_ definitions and perform a final update
-  this->SetLEDs(c.r, c.g, c.b);
-  this->Update();
+Error FastLEDController::BeginFade(uint32_t fade_ms, CRGB c) {
+  memcpy(this->fade_from_, this->leds_, this->num_leds_ * sizeof(CRGB));
+  this->fade_to_ = c;
+  this->StartFade(fade_ms, this->num_leds_ * (c.r + c.g + c.b));
   return NoError;
 }
 
-Error FastLEDController::Update() {
-  this->controller_->showLeds();
+Error FastLEDController::BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                                        uint32_t count) {
+  if (this->fade_target_ == nullptr) {
+    this->fade_target_ = new CRGB[this->num_leds_];
+    this->CountAllocations(1);
+  }
+  // CRGB is laid out like Pixel, so the frame can be captured as one
+  return this->StartCrossFade(fade_ms, reinterpret_cast<Pixel *>(this->leds_),
+                              reinterpret_cast<Pixel *>(this->fade_from_),
+                              reinterpret_cast<Pixel *>(this->fade_target_),
+                              this->num_leds_, target, count);
+}
+
+Error FastLEDController::RenderFade(uint16_t weight) {
+  // move every channel of every pixel from its starting value towards the
+  // target in proportion to weight
+  uint8_t *leds = reinterpret_cast<uint8_t *>(this->leds_);
+  const uint8_t *from = reinterpret_cast<const uint8_t *>(this->fade_from_);
+  const size_t len = this->num_leds_ * sizeof(CRGB);
+  if (this->IsCrossFade()) {
+    LerpBuffer(leds, from,
+               reinterpret_cast<const uint8_t *>(this->fade_target_), len,
+               weight);
+  } else {
+    LerpToColor(leds, from, len, this->fade_to_.raw, sizeof(CRGB), weight);
+  }
+  return this->Update();
+}
+
+Error FastLEDController::EndFade() {
+  // a crossfade lands exactly on its target frame
+  if (this->IsCrossFade()) {
+    return this->RenderFade(kLerpOne);
+  }
+  // update our local led definitions and perform a final update
+  this->SetLEDs(this->fade_to_.r, this->fade_to_.g, this->fade_to_.b);
+  return this->Update();
+}
+
+Error FastLEDController::Transmit() {
+  const OutputStage *stage = this->GetOutputStage();
+  CRGB *wire = this->leds_;
+  if (stage != nullptr) {
+    if (this->out_ == nullptr) {
+      this->out_ = new CRGB[this->num_leds_];
+      this->CountAllocations(1);
+    }
+    stage->Apply(reinterpret_cast<const Pixel *>(this->leds_),
+                 reinterpret_cast<Pixel *>(this->out_), this->num_leds_);
+    wire = this->out_;
+  }
+  if (this->controller_->leds() != wire) {
+    this->controller_->setLeds(wire, static_cast<int>(this->num_leds_));
+  }
+  // FastLED scales by the power limit as it encodes the frame for the wire
+  this->controller_->showLeds(this->GetPowerScale());
   return NoError;
 }
 
@@ -82,25 +126,51 @@ Error FastLEDController::Fade(uint32_t fade_ms, uint8_t r, uint8_t g,
   return this->Fade(fade_ms, CRGB(r, g, b));
 }
 
+Error FastLEDController::BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g,
+                                   uint8_t b) {
+  return this->BeginFade(fade_ms, CRGB(r, g, b));
+}
+
 Error FastLEDController::SetLEDs(uint8_t r, uint8_t g, uint8_t b) {
   for (uint32_t i = 0; i < this->num_leds_; i++) {
     this->leds_[i].r = r;
     this->leds_[i].g = g;
     this->leds_[i].b = b;
   }
+  this->TrackFrame(this->num_leds_ * (r + g + b));
   return NoError;
 }
 
 Error FastLEDController::SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) {
-  if (i > this->num_leds_) {
+  if (i >= this->num_leds_) {
     return LEDIndexOutOfRange;
   }
+  const CRGB &old = this->leds_[i];
+  this->TrackPixel(old.r + old.g + old.b, r + g + b);
   this->leds_[i].r = r;
   this->leds_[i].g = g;
   this->leds_[i].b = b;
   return NoError;
 }
 
+Error FastLEDController::SetRange(uint32_t first, uint32_t count, uint8_t r,
+                                  uint8_t g, uint8_t b) {
+  return this->FillRange(reinterpret_cast<Pixel *>(this->leds_),
+                         this->num_leds_, first, count, Pixel{r, g, b});
+}
+
+Error FastLEDController::Blit(uint32_t first, const Pixel *src,
+                              uint32_t count) {
+  return this->BlitRange(reinterpret_cast<Pixel *>(this->leds_),
+                         this->num_leds_, first, src, count);
+}
+
+Error FastLEDController::GetFrame(uint32_t first, Pixel *dst,
+                                  uint32_t count) const {
+  return ReadRange(reinterpret_cast<const Pixel *>(this->leds_),
+                   this->num_leds_, first, dst, count);
+}
+
 }  // namespace LightShow
 
-#endif  // LIGHTSHOW_FASTLED_ENABLE
+#endif  // LIGHTSHOW_FASTLED_ENABLE && !LIGHTSHOW_NO_HEAP
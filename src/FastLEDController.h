@@ -28,7 +28,7 @@
 
 #include "Controller.h"
 
-#if LIGHTSHOW_FASTLED_ENABLE == 1
+#if LIGHTSHOW_FASTLED_ENABLE == 1 && LIGHTSHOW_NO_HEAP != 1
 
 #include <memory>
 
@@ -42,7 +42,7 @@ namespace LightShow {
 #define LIGHTSHOW_FASTLED_DATA_PIN 0
 #endif
 
-class FastLEDController : public Controller {
+class FastLEDController final : public Controller {
  public:
   /**
    * Create a FastLED controller_ for NeoPixels.
@@ -77,6 +77,28 @@ class FastLEDController : public Controller {
    */
   Error Fade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) override;
 
+  /**
+   * Begin fading to a color
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Begin crossfading to a frame
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param target the color to fade each LED to, count long
+   * @param count the number of LEDs in target
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                       uint32_t count) override;
+
   /**
    * Set all LEDs to a color
    * @param r Red brightness, 0 to 255.
@@ -97,12 +119,44 @@ class FastLEDController : public Controller {
   Error SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) override;
 
   /**
-   * reads the local pixel values and pushing them to the leds_
+   * Set a run of LEDs to a color
+   * @param first the index of the first LED to set (0-indexed)
+   * @param count the number of LEDs to set
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
    * @return 0 on success or a LightShow::Error on error
    */
-  Error Update() override;
+  Error SetRange(uint32_t first, uint32_t count, uint8_t r, uint8_t g,
+                 uint8_t b) override;
+
+  /**
+   * Copy a run of pixels onto the LEDs
+   * @param first the index of the first LED to set (0-indexed)
+   * @param src the pixels to copy, count long
+   * @param count the number of pixels to copy
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Blit(uint32_t first, const Pixel *src, uint32_t count) override;
+
+  /**
+   * Read back a run of LEDs
+   * @param first the index of the first LED to read (0-indexed)
+   * @param dst where to copy the pixels, count long
+   * @param count the number of pixels to read
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error GetFrame(uint32_t first, Pixel *dst, uint32_t count) const override;
 
  protected:
+  /**
+   * reads the local pixel values and pushing them to the leds_
+   * With an output stage, the corrected pixels are copied to out_, and FastLED
+   * is pointed at that instead.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Transmit() override;
+
   /**
    * Fade to a color
    * This is a blocking operation.
@@ -112,6 +166,29 @@ class FastLEDController : public Controller {
    */
   Error Fade(uint32_t fade_ms, CRGB c);
 
+  /**
+   * Begin fading to a color
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param c the hue color to fade to
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginFade(uint32_t fade_ms, CRGB c);
+
+  /**
+   * Render and push one frame of the running fade
+   * @param weight the progress made across the fade in Q8 fixed point, 0 to
+   * kLerpOne
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error RenderFade(uint16_t weight) override;
+
+  /**
+   * Set and push the fade target once the fade has completed
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error EndFade() override;
+
   /**
    * a pointer to the led storage for direct access
    *
@@ -131,6 +208,23 @@ class FastLEDController : public Controller {
   /// the known size of the NeoPixel strip, since it is frequently referenced
   uint32_t num_leds_;
 
+  /**
+   * a snapshot of the LED values at the start of the running fade
+   *
+   * This is allocated once by the constructor and reused by every fade.
+   */
+  CRGB *fade_from_;
+
+  /// the color that the running fade is heading towards
+  CRGB fade_to_;
+
+  /// the frame that the running crossfade is heading towards, allocated by
+  /// the first crossfade
+  CRGB *fade_target_ = nullptr;
+
+  /// the corrected pixels, allocated the first time an output stage is used
+  CRGB *out_ = nullptr;
+
  private:
   /**
    * disallow copying by making the copy constructor private
@@ -155,6 +249,6 @@ class FastLEDController : public Controller {
 };
 }  // namespace LightShow
 
-#endif  // LIGHTSHOW_FASTLED_ENABLE
+#endif  // LIGHTSHOW_FASTLED_ENABLE && !LIGHTSHOW_NO_HEAP
 
 #endif  // LIGHTSHOW_FASTLEDCONTROLLER_H
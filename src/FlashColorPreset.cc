@@ -25,39 +25,8 @@
 
 #include "FlashColorPreset.h"
 
-#include <utility>
-
 namespace LightShow {
 
-FlashColorPreset::FlashColorPreset(std::shared_ptr<Controller> controller,
-                                   uint8_t r, uint8_t g, uint8_t b,
-                                   uint32_t interval)
-    : controller_(std::move(controller)),
-      r_(r),
-      g_(g),
-      b_(b),
-      interval_(interval) {}
-
-Error FlashColorPreset::Loop() {
-  // skip this cycle if it's not time to flash yet
-  if (++this->loop_count_ < this->interval_) {
-    return NoError;
-  }
-
-  // it's time to flash, reset the counter
-  this->loop_count_ = 0;
-
-  // currently showing, time to disable
-  if (this->showing_) {
-    this->controller_->SetLEDs(0, 0, 0);
-    this->showing_ = false;
-  } else {
-    this->controller_->SetLEDs(this->r_, this->g_, this->b_);
-    this->showing_ = true;
-  }
-  this->controller_->Update();
-
-  return NoError;
-}
+template class BasicFlashColorPreset<Controller>;
 
 }  // namespace LightShow
@@ -26,38 +26,95 @@
 #ifndef LIGHTSHOW_FLASHCOLORPRESET_H
 #define LIGHTSHOW_FLASHCOLORPRESET_H
 
-#include <memory>
-
+#include "LightShow.h"
 #include "Preset.h"
 
+#if LIGHTSHOW_NO_HEAP != 1
+#include <memory>
+#include <utility>
+#endif
+
 namespace LightShow {
 
 /**
  * flash a color
+ *
+ * Use the FlashColorPreset typedef to drive any Controller through its virtual
+ * interface, or name a concrete controller type as ControllerT so that its
+ * methods are called directly.
+ * @tparam ControllerT the type of the controller used to set LEDs
  */
-class FlashColorPreset : public Preset {
+template <class ControllerT>
+class BasicFlashColorPreset : public Preset {
  public:
   /**
-   * Create a preset that flashes a color
+   * Create a preset for a controller that outlives it, such as a global
+   * @param controller the controller used to set LEDs
+   * @param r red 0-255
+   * @param g green 0-255
+   * @param b blue 0-255
+   * @param interval the number of loop cycles between flashes
+   */
+  explicit BasicFlashColorPreset(ControllerT &controller,  // NOLINT
+                                 uint8_t r = 0xFF, uint8_t g = 0xFF,
+                                 uint8_t b = 0xFF, uint32_t interval = 1)
+      : controller_(&controller),
+        r_(r),
+        g_(g),
+        b_(b),
+        interval_(interval) {}
+
+#if LIGHTSHOW_NO_HEAP != 1
+  /**
+   * Create a preset that keeps its controller alive
    * @param controller the controller used to set LEDs
    * @param r red 0-255
    * @param g green 0-255
    * @param b blue 0-255
    * @param interval the number of loop cycles between flashes
    */
-  explicit FlashColorPreset(std::shared_ptr<Controller> controller,
-                            uint8_t r = 0xFF, uint8_t g = 0xFF,
-                            uint8_t b = 0xFF, uint32_t interval = 1);
+  explicit BasicFlashColorPreset(std::shared_ptr<ControllerT> controller,
+                                 uint8_t r = 0xFF, uint8_t g = 0xFF,
+                                 uint8_t b = 0xFF, uint32_t interval = 1)
+      : BasicFlashColorPreset(*controller, r, g, b, interval) {
+    this->owner_ = std::move(controller);
+  }
+#endif
+
+  /**
+   * Start this preset
+   * In time-based mode, the color is shown from this point.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Start() override;
 
   /**
    * Perform one loop
+   * LEDs are only set and pushed when the preset flips, or, in time-based
+   * mode, when something else has written to the controller since the last
+   * push.
    * @return 0 on success or a LightShow::Error on error
    */
   Error Loop() override;
 
+  /**
+   * Flash by wall-clock time instead of by loop count
+   * The color is shown for the first half of each period and turned off for
+   * the second half, so the speed of the flash does not depend on how fast
+   * loop() runs.  interval is ignored in this mode.
+   * @param period_ms the time taken for one on and off cycle, in milliseconds,
+   * or 0 to flip every interval loop cycles
+   */
+  void SetPeriod(uint32_t period_ms);
+
  protected:
   /// controller that will be used to set LEDs
-  std::shared_ptr<Controller> controller_;
+  ControllerT *controller_;
+
+#if LIGHTSHOW_NO_HEAP != 1
+  /// keeps controller_ alive, if the preset was given shared ownership of it
+  std::shared_ptr<ControllerT> owner_;
+#endif
 
   /// red byte of the color to cycle
   uint8_t r_;
@@ -76,8 +133,74 @@ class FlashColorPreset : public Preset {
 
   /// how many loop cycles to skip before flipping
   uint32_t interval_;
+
+  /// the time taken for one on and off cycle, or 0 to flip by loop count
+  uint32_t period_ms_ = 0;
+
+  /// the millis() time at which the preset was started
+  uint32_t start_ms_ = 0;
+
+  /// true once the LEDs have been set to match showing_
+  bool pushed_ = false;
+
+  /// the controller's frame version once the LEDs were set, so that a frame
+  /// drawn over by a fade, a show or another preset is pushed again
+  uint32_t version_ = 0;
 };
 
+/// a flash that drives any Controller through its virtual interface
+typedef BasicFlashColorPreset<Controller> FlashColorPreset;
+
+// the virtual version is compiled once, in FlashColorPreset.cc
+extern template class BasicFlashColorPreset<Controller>;
+
+template <class ControllerT>
+Error BasicFlashColorPreset<ControllerT>::Start() {
+  this->start_ms_ = millis();
+  this->pushed_ = false;
+  return NoError;
+}
+
+template <class ControllerT>
+void BasicFlashColorPreset<ControllerT>::SetPeriod(uint32_t period_ms) {
+  this->period_ms_ = period_ms;
+}
+
+template <class ControllerT>
+Error BasicFlashColorPreset<ControllerT>::Loop() {
+  this->controller_->BeginRender();
+  if (this->period_ms_ != 0) {
+    // show the color for the first half of each period
+    const uint32_t phase = (millis() - this->start_ms_) % this->period_ms_;
+    const bool showing = phase < (this->period_ms_ + 1) / 2;
+
+    // nothing to do if the LEDs already match
+    if (this->pushed_ && showing == this->showing_ &&
+        this->controller_->GetFrameVersion() == this->version_) {
+      return NoError;
+    }
+    this->showing_ = showing;
+  } else {
+    // skip this cycle if it's not time to flash yet
+    if (++this->loop_count_ < this->interval_) {
+      return NoError;
+    }
+
+    // it's time to flash, reset the counter and flip
+    this->loop_count_ = 0;
+    this->showing_ = !this->showing_;
+  }
+  this->pushed_ = true;
+
+  if (this->showing_) {
+    this->controller_->SetLEDs(this->r_, this->g_, this->b_);
+  } else {
+    this->controller_->SetLEDs(0, 0, 0);
+  }
+  this->version_ = this->controller_->GetFrameVersion();
+  return this->PushFrame(this->controller_);
+}
+
 }  // namespace LightShow
 
 #endif  // LIGHTSHOW_FLASHCOLORPRESET_H
@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "FrameSource.h"
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LightShow {
+
+MemoryFrameSource::MemoryFrameSource(const uint8_t *data, size_t len,
+                                     bool progmem)
+    : data_(data), len_(len), progmem_(progmem) {}
+
+size_t MemoryFrameSource::Read(uint8_t *buffer, size_t len) {
+  const size_t left = this->len_ - this->pos_;
+  if (len > left) {
+    len = left;
+  }
+  if (this->progmem_) {
+    memcpy_P(buffer, this->data_ + this->pos_, len);
+  } else {
+    memcpy(buffer, this->data_ + this->pos_, len);
+  }
+  this->pos_ += len;
+  return len;
+}
+
+bool MemoryFrameSource::Rewind() {
+  this->pos_ = 0;
+  return true;
+}
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+
+MappedFrameSource::MappedFrameSource(const char *path)
+    : MemoryFrameSource(nullptr, 0, false) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void *data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                      MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      this->data_ = static_cast<const uint8_t *>(data);
+      this->len_ = static_cast<size_t>(st.st_size);
+    }
+  }
+  close(fd);
+}
+
+MappedFrameSource::~MappedFrameSource() {
+  if (this->data_ != nullptr) {
+    munmap(const_cast<uint8_t *>(this->data_), this->len_);
+  }
+}
+
+bool MappedFrameSource::IsOpen() const { return this->data_ != nullptr; }
+
+#endif  // LIGHTSHOW_SIMULATED_ENABLE
+
+}  // namespace LightShow
@@ -0,0 +1,218 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_FRAMESOURCE_H
+#define LIGHTSHOW_FRAMESOURCE_H
+
+#include <Arduino.h>
+
+#include "LightShow.h"
+
+namespace LightShow {
+
+/**
+ * the layout of a recorded show
+ *
+ * A recorded show starts with a 16-byte header:
+ *   4 bytes  magic "LSF1"
+ *   4 bytes  the number of pixels per frame
+ *   4 bytes  the number of frames
+ *   2 bytes  the time between frames, in milliseconds
+ *   2 bytes  reserved, 0
+ * Each frame follows as:
+ *   1 byte   kFrameKey to start from black, or kFrameDelta to start from the
+ *            previous frame
+ *   4 bytes  the length of the encoded pixels
+ *   ...      the encoded pixels, as a run of tokens over the r, g, b bytes
+ * A token below 0x80 skips (token + 1) bytes, leaving them as they are.  A
+ * token from 0x80 to 0xBF is followed by ((token & 0x3F) + 1) bytes, which are
+ * XORed into the frame.  A token from 0xC0 up is followed by 3 bytes, which
+ * are XORed into each of the next ((token & 0x3F) + 1) pixels.  A keyframe is
+ * therefore a delta from black.  Numbers are little-endian.
+ */
+namespace ShowFile {
+
+/// the length of the file header
+constexpr uint8_t kHeaderLength = 16;
+
+/// the length of each frame header
+constexpr uint8_t kFrameHeaderLength = 5;
+
+/// a frame that starts from black
+constexpr uint8_t kFrameKey = 1;
+
+/// a frame that starts from the previous frame
+constexpr uint8_t kFrameDelta = 0;
+
+/// the first token value that introduces XORed bytes
+constexpr uint8_t kLiteral = 0x80;
+
+/// the first token value that introduces a repeated pixel
+constexpr uint8_t kRepeat = 0xC0;
+
+/// the most bytes skipped by one token
+constexpr uint8_t kMaxSkip = 0x80;
+
+/// the most bytes, or pixels, covered by any other token
+constexpr uint8_t kMaxRun = 0x40;
+
+}  // namespace ShowFile
+
+/**
+ * somewhere to read a recorded show from
+ */
+class FrameSource {
+ public:
+  virtual ~FrameSource() = default;
+
+  /**
+   * Read the next bytes of the show
+   * @param buffer where to store the bytes
+   * @param len the most bytes to read
+   * @return the number of bytes read, which is less than len at the end
+   */
+  virtual size_t Read(uint8_t *buffer, size_t len) = 0;
+
+  /**
+   * Go back to the start of the show
+   * @return true on success, else false
+   */
+  virtual bool Rewind() = 0;
+};
+
+/**
+ * a recorded show held in memory
+ *
+ * Shows compiled into the sketch are read from program memory.  On a host, the
+ * memory may be a mapped file; see MappedFrameSource.
+ */
+class MemoryFrameSource : public FrameSource {
+ public:
+  /**
+   * Create a source
+   * @param data the show
+   * @param len the length of the show
+   * @param progmem true if data is in program memory
+   */
+  MemoryFrameSource(const uint8_t *data, size_t len, bool progmem = true);
+
+  /**
+   * Read the next bytes of the show
+   * @param buffer where to store the bytes
+   * @param len the most bytes to read
+   * @return the number of bytes read, which is less than len at the end
+   */
+  size_t Read(uint8_t *buffer, size_t len) override;
+
+  /**
+   * Go back to the start of the show
+   * @return true
+   */
+  bool Rewind() override;
+
+ protected:
+  /// the show
+  const uint8_t *data_;
+
+  /// the length of the show
+  size_t len_;
+
+  /// the offset of the next byte to read
+  size_t pos_ = 0;
+
+  /// true if data_ is in program memory
+  bool progmem_;
+};
+
+/**
+ * a recorded show read from a file, such as an SD card File
+ * @tparam FileT a type with read(buffer, len) and seek(position), like the
+ * File class of the Arduino SD library
+ */
+template <class FileT>
+class FileFrameSource : public FrameSource {
+ public:
+  /**
+   * Create a source
+   * @param file the open file, which must outlive the source
+   */
+  explicit FileFrameSource(FileT *file) : file_(file) {}
+
+  /**
+   * Read the next bytes of the show
+   * @param buffer where to store the bytes
+   * @param len the most bytes to read
+   * @return the number of bytes read, which is less than len at the end
+   */
+  size_t Read(uint8_t *buffer, size_t len) override {
+    const int n = this->file_->read(buffer, len);
+    return (n > 0) ? static_cast<size_t>(n) : 0;
+  }
+
+  /**
+   * Go back to the start of the show
+   * @return true on success, else false
+   */
+  bool Rewind() override { return this->file_->seek(0); }
+
+ protected:
+  /// the open file
+  FileT *file_;
+};
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+
+/**
+ * a recorded show in a file mapped into memory, on a host
+ */
+class MappedFrameSource : public MemoryFrameSource {
+ public:
+  /**
+   * Map a file
+   * @param path the file to map
+   */
+  explicit MappedFrameSource(const char *path);
+
+  /**
+   * Unmap the file
+   */
+  ~MappedFrameSource();
+
+  /**
+   * check whether the file was mapped
+   * @return true if the file is mapped, else false
+   */
+  bool IsOpen() const;
+
+ private:
+  MappedFrameSource(const MappedFrameSource &) = delete;
+  MappedFrameSource &operator=(const MappedFrameSource &) = delete;
+};
+
+#endif  // LIGHTSHOW_SIMULATED_ENABLE
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_FRAMESOURCE_H
@@ -0,0 +1,190 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "Lerp.h"
+
+namespace LightShow {
+
+#if LIGHTSHOW_LERP_SWAR == 1
+
+namespace {
+
+/// the even bytes of a word, each in its own 16-bit lane
+constexpr uint32_t kEvenBytes = 0x00FF00FF;
+
+/**
+ * interpolate four channels packed into a word
+ *
+ * The even and odd bytes are split into 16-bit lanes, so one 32-bit multiply
+ * works on two channels at once.  No lane can overflow, as
+ * from * (256 - weight) + to * weight never exceeds 255 * 256.
+ * @param from four channels at weight 0
+ * @param from_weight kLerpOne - weight
+ * @param even_to the even bytes of the target, already multiplied by weight
+ * @param odd_to the odd bytes of the target, already multiplied by weight
+ * @return four interpolated channels
+ */
+inline uint32_t LerpWord(uint32_t from, uint32_t from_weight, uint32_t even_to,
+                         uint32_t odd_to) {
+  const uint32_t even = ((from & kEvenBytes) * from_weight + even_to) >> 8;
+  const uint32_t odd = ((from >> 8) & kEvenBytes) * from_weight + odd_to;
+  return (even & kEvenBytes) | (odd & ~kEvenBytes);
+}
+
+/**
+ * read a word from a buffer that may not be aligned
+ * @param p the address to read
+ * @return the word at p
+ */
+inline uint32_t LoadWord(const uint8_t *p) {
+  uint32_t word;
+  memcpy(&word, p, sizeof(word));
+  return word;
+}
+
+/**
+ * write a word to a buffer that may not be aligned
+ * @param p the address to write
+ * @param word the word to store at p
+ */
+inline void StoreWord(uint8_t *p, uint32_t word) {
+  memcpy(p, &word, sizeof(word));
+}
+
+}  // namespace
+
+void LerpToColor(uint8_t *out, const uint8_t *from, size_t len,
+                 const uint8_t *color, uint8_t stride, uint16_t weight) {
+  // 12 bytes holds a whole number of pixels for every stride from 1 to 4, so
+  // the target repeats every three words
+  uint8_t pattern[12];
+  for (uint8_t i = 0; i < sizeof(pattern); i++) {
+    pattern[i] = color[i % stride];
+  }
+
+  // the target is the same for every pixel, so weigh it once up front
+  uint32_t even_to[3];
+  uint32_t odd_to[3];
+  for (uint8_t p = 0; p < 3; p++) {
+    const uint32_t word = LoadWord(pattern + p * 4);
+    even_to[p] = (word & kEvenBytes) * weight;
+    odd_to[p] = ((word >> 8) & kEvenBytes) * weight;
+  }
+
+  const uint32_t from_weight = kLerpOne - weight;
+  size_t i = 0;
+  for (; i + 12 <= len; i += 12) {
+    StoreWord(out + i, LerpWord(LoadWord(from + i), from_weight, even_to[0],
+                                odd_to[0]));
+    StoreWord(out + i + 4, LerpWord(LoadWord(from + i + 4), from_weight,
+                                    even_to[1], odd_to[1]));
+    StoreWord(out + i + 8, LerpWord(LoadWord(from + i + 8), from_weight,
+                                    even_to[2], odd_to[2]));
+  }
+  for (; i < len; i++) {
+    out[i] = Lerp8(from[i], pattern[i % sizeof(pattern)], weight);
+  }
+}
+
+void LerpBuffer(uint8_t *out, const uint8_t *from, const uint8_t *to,
+                size_t len, uint16_t weight) {
+  const uint32_t from_weight = kLerpOne - weight;
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    const uint32_t word = LoadWord(to + i);
+    StoreWord(out + i,
+              LerpWord(LoadWord(from + i), from_weight,
+                       (word & kEvenBytes) * weight,
+                       ((word >> 8) & kEvenBytes) * weight));
+  }
+  for (; i < len; i++) {
+    out[i] = Lerp8(from[i], to[i], weight);
+  }
+}
+
+uint32_t SumBuffer(const uint8_t *in, size_t len) {
+  // add the even and odd bytes of each word into two 16-bit lanes; each word
+  // adds at most 2 * 255 to a lane, so 128 words fit before it must be folded
+  uint32_t sum = 0;
+  size_t i = 0;
+  while (i + 4 <= len) {
+    uint32_t lanes = 0;
+    for (size_t n = 0; n < 128 && i + 4 <= len; n++, i += 4) {
+      const uint32_t word = LoadWord(in + i);
+      lanes += (word & kEvenBytes) + ((word >> 8) & kEvenBytes);
+    }
+    sum += (lanes & 0xFFFF) + (lanes >> 16);
+  }
+  for (; i < len; i++) {
+    sum += in[i];
+  }
+  return sum;
+}
+
+#else  // LIGHTSHOW_LERP_SWAR
+
+void LerpToColor(uint8_t *out, const uint8_t *from, size_t len,
+                 const uint8_t *color, uint8_t stride, uint16_t weight) {
+  // the target is the same for every pixel, so weigh it once up front
+  uint16_t to[4];
+  for (uint8_t c = 0; c < stride; c++) {
+    to[c] = color[c] * weight;
+  }
+
+  const uint16_t from_weight = kLerpOne - weight;
+  uint8_t c = 0;
+  for (size_t i = 0; i < len; i++) {
+    out[i] = static_cast<uint8_t>((from[i] * from_weight + to[c]) >> 8);
+    if (++c == stride) {
+      c = 0;
+    }
+  }
+}
+
+void LerpBuffer(uint8_t *out, const uint8_t *from, const uint8_t *to,
+                size_t len, uint16_t weight) {
+  for (size_t i = 0; i < len; i++) {
+    out[i] = Lerp8(from[i], to[i], weight);
+  }
+}
+
+uint32_t SumBuffer(const uint8_t *in, size_t len) {
+  uint32_t sum = 0;
+  for (size_t i = 0; i < len; i++) {
+    sum += in[i];
+  }
+  return sum;
+}
+
+#endif  // LIGHTSHOW_LERP_SWAR
+
+void ScaleBuffer(uint8_t *out, const uint8_t *in, size_t len, uint8_t scale) {
+  const uint16_t factor = scale + 1;
+  for (size_t i = 0; i < len; i++) {
+    out[i] = static_cast<uint8_t>((in[i] * factor) >> 8);
+  }
+}
+
+}  // namespace LightShow
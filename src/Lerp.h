@@ -0,0 +1,105 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_LERP_H
+#define LIGHTSHOW_LERP_H
+
+#include <Arduino.h>
+
+#include "LightShow.h"
+
+namespace LightShow {
+
+/// the interpolation weight that lands exactly on the target value (1.0)
+constexpr uint16_t kLerpOne = 256;
+
+/**
+ * interpolate between two channel values
+ * @param from the value at weight 0
+ * @param to the value at weight kLerpOne
+ * @param weight the progress from from to to in Q8 fixed point, 0 to kLerpOne
+ * @return the interpolated value
+ */
+inline uint8_t Lerp8(uint8_t from, uint8_t to, uint16_t weight) {
+  return static_cast<uint8_t>((from * (kLerpOne - weight) + to * weight) >> 8);
+}
+
+/**
+ * scale a channel value by a fraction
+ * @param value the value to scale
+ * @param scale the fraction to scale by, where 0 gives 0 and 255 gives value
+ * @return the scaled value
+ */
+inline uint8_t Scale8(uint8_t value, uint8_t scale) {
+  return static_cast<uint8_t>((value * (scale + 1)) >> 8);
+}
+
+/**
+ * add up a buffer of channel values
+ * @param in the values to add up, len bytes long
+ * @param len the number of bytes to add up
+ * @return the sum of the values
+ */
+uint32_t SumBuffer(const uint8_t *in, size_t len);
+
+/**
+ * scale a buffer of channel values by a fraction
+ * @param out the buffer to write, len bytes long (may be the same as in)
+ * @param in the values to scale, len bytes long
+ * @param len the number of bytes to scale
+ * @param scale the fraction to scale by, where 0 gives 0 and 255 gives in
+ */
+void ScaleBuffer(uint8_t *out, const uint8_t *in, size_t len, uint8_t scale);
+
+/**
+ * interpolate a buffer of channel values towards a single repeating color
+ *
+ * The buffer is treated as a run of pixels of stride bytes each, so it works
+ * on any channel order.  Both directions are exact at the end points: weight 0
+ * yields from, and weight kLerpOne yields color.
+ * @param out the buffer to write, len bytes long (may be the same as from)
+ * @param from the values at weight 0, len bytes long
+ * @param len the number of bytes to interpolate
+ * @param color the target pixel, stride bytes in buffer order
+ * @param stride the number of bytes per pixel, 1 to 4
+ * @param weight the progress towards color in Q8 fixed point, 0 to kLerpOne
+ */
+void LerpToColor(uint8_t *out, const uint8_t *from, size_t len,
+                 const uint8_t *color, uint8_t stride, uint16_t weight);
+
+/**
+ * interpolate a buffer of channel values towards another buffer
+ * @param out the buffer to write, len bytes long (may be the same as from)
+ * @param from the values at weight 0, len bytes long
+ * @param to the values at weight kLerpOne, len bytes long
+ * @param len the number of bytes to interpolate
+ * @param weight the progress towards to in Q8 fixed point, 0 to kLerpOne
+ */
+void LerpBuffer(uint8_t *out, const uint8_t *from, const uint8_t *to,
+                size_t len, uint16_t weight);
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_LERP_H
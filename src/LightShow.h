@@ -36,4 +36,50 @@
 #define LIGHTSHOW_FASTLED_ENABLE 1
 #endif
 
+/// Whether SimulatedController and VirtualClock should be compiled-in (set to 1
+/// to enable; these are meant for host builds using the shim in extras/host)
+#ifndef LIGHTSHOW_SIMULATED_ENABLE
+#define LIGHTSHOW_SIMULATED_ENABLE 0
+#endif
+
+/// Whether NeoPixelController should write pixels straight into the NeoPixel
+/// library's buffer instead of keeping its own copy (set to 1 to enable)
+#ifndef LIGHTSHOW_NEOPIXEL_ZEROCOPY
+#define LIGHTSHOW_NEOPIXEL_ZEROCOPY 0
+#endif
+
+/// Whether controllers should record frame timing statistics (set to 1 to
+/// enable; when disabled, the instrumentation compiles to nothing)
+#ifndef LIGHTSHOW_STATS_ENABLE
+#define LIGHTSHOW_STATS_ENABLE 0
+#endif
+
+/// Whether StaticController should hold a buffer for the target of a crossfade
+/// (set to 0 to save a frame of RAM in sketches that never crossfade; off by
+/// default on 8-bit AVRs, where a frame is a large part of the RAM)
+#ifndef LIGHTSHOW_STATIC_CROSSFADE
+#ifdef __AVR__
+#define LIGHTSHOW_STATIC_CROSSFADE 0
+#else
+#define LIGHTSHOW_STATIC_CROSSFADE 1
+#endif
+#endif
+
+/// Whether the library must run without the heap (set to 1 to enable; only
+/// StaticController, show programs, output correction and the color presets
+/// are compiled-in, and presets hold plain pointers to their controllers)
+#ifndef LIGHTSHOW_NO_HEAP
+#define LIGHTSHOW_NO_HEAP 0
+#endif
+
+/// Whether fades should interpolate several channels per 32-bit word (set to 0
+/// to interpolate one byte at a time, which is faster on 8-bit AVRs)
+#ifndef LIGHTSHOW_LERP_SWAR
+#ifdef __AVR__
+#define LIGHTSHOW_LERP_SWAR 0
+#else
+#define LIGHTSHOW_LERP_SWAR 1
+#endif
+#endif
+
 #endif  // LIGHTSHOW_H
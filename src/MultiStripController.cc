@@ -0,0 +1,209 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "MultiStripController.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <algorithm>
+#include <utility>
+
+namespace LightShow {
+
+MultiStripController::MultiStripController(uint32_t num)
+    : frame_(num), fade_from_(num), fade_to_() {
+  this->CountAllocations(2);
+  this->TrackPower(num);
+}
+
+Error MultiStripController::AddStrip(uint32_t count,
+                                     std::unique_ptr<StripOutput> output) {
+  if (count > this->frame_.size() - this->assigned_) {
+    return LEDIndexOutOfRange;
+  }
+
+  auto e = output->Begin(this->frame_.data() + this->assigned_, count);
+  if (e != NoError) {
+    return e;
+  }
+
+  Strip strip;
+  strip.first = this->assigned_;
+  strip.count = count;
+  strip.time_us = 0;
+  strip.output = std::move(output);
+  // the strip's output was allocated by the caller, and the list may grow
+  const bool grows = this->strips_.size() == this->strips_.capacity();
+  this->CountAllocations(grows ? 2 : 1);
+  this->strips_.push_back(std::move(strip));
+  this->assigned_ += count;
+  return NoError;
+}
+
+void MultiStripController::SetParallelOutput(bool parallel) {
+  this->parallel_ = parallel;
+}
+
+Error MultiStripController::BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g,
+                                      uint8_t b) {
+  std::copy(this->frame_.begin(), this->frame_.end(),
+            this->fade_from_.begin());
+  this->fade_to_.r = r;
+  this->fade_to_.g = g;
+  this->fade_to_.b = b;
+  this->StartFade(fade_ms,
+                  static_cast<uint32_t>(this->frame_.size()) * (r + g + b));
+  return NoError;
+}
+
+Error MultiStripController::BeginCrossFade(uint32_t fade_ms,
+                                           const Pixel *target,
+                                           uint32_t count) {
+  const uint32_t size = static_cast<uint32_t>(this->frame_.size());
+  if (this->fade_target_.empty()) {
+    this->fade_target_.resize(size);
+    this->CountAllocations(1);
+  }
+  return this->StartCrossFade(fade_ms, this->frame_.data(),
+                              this->fade_from_.data(),
+                              this->fade_target_.data(), size, target, count);
+}
+
+Error MultiStripController::RenderFade(uint16_t weight) {
+  uint8_t *frame = reinterpret_cast<uint8_t *>(this->frame_.data());
+  const uint8_t *from =
+      reinterpret_cast<const uint8_t *>(this->fade_from_.data());
+  const size_t len = this->frame_.size() * sizeof(Pixel);
+  if (this->IsCrossFade()) {
+    LerpBuffer(frame, from,
+               reinterpret_cast<const uint8_t *>(this->fade_target_.data()),
+               len, weight);
+  } else {
+    LerpToColor(frame, from, len,
+                reinterpret_cast<const uint8_t *>(&this->fade_to_),
+                sizeof(Pixel), weight);
+  }
+  return this->Update();
+}
+
+Error MultiStripController::EndFade() { return this->RenderFade(kLerpOne); }
+
+Error MultiStripController::SetLEDs(uint8_t r, uint8_t g, uint8_t b) {
+  for (auto &item : this->frame_) {
+    item.r = r;
+    item.g = g;
+    item.b = b;
+  }
+  this->TrackFrame(static_cast<uint32_t>(this->frame_.size()) * (r + g + b));
+  return NoError;
+}
+
+Error MultiStripController::SetLED(uint32_t i, uint8_t r, uint8_t g,
+                                   uint8_t b) {
+  if (i >= this->frame_.size()) {
+    return LEDIndexOutOfRange;
+  }
+  const Pixel &old = this->frame_[i];
+  this->TrackPixel(old.r + old.g + old.b, r + g + b);
+  this->frame_[i].r = r;
+  this->frame_[i].g = g;
+  this->frame_[i].b = b;
+  return NoError;
+}
+
+Error MultiStripController::SetRange(uint32_t first, uint32_t count, uint8_t r,
+                                     uint8_t g, uint8_t b) {
+  return this->FillRange(this->frame_.data(), this->frame_.size(), first, count,
+                         Pixel{r, g, b});
+}
+
+Error MultiStripController::Blit(uint32_t first, const Pixel *src,
+                                 uint32_t count) {
+  return this->BlitRange(this->frame_.data(), this->frame_.size(), first, src,
+                         count);
+}
+
+Error MultiStripController::GetFrame(uint32_t first, Pixel *dst,
+                                     uint32_t count) const {
+  return ReadRange(this->frame_.data(), this->frame_.size(), first, dst, count);
+}
+
+Error MultiStripController::Transmit() {
+  const uint32_t start = micros();
+  const OutputStage *stage = this->GetOutputStage();
+  const uint8_t scale = this->GetPowerScale();
+  Error result = NoError;
+
+  // push this controller's FastLED strips back to back, ahead of the others;
+  // this only orders the pushes, and leaves any batching to the driver
+  if (this->parallel_) {
+    for (auto &strip : this->strips_) {
+      if (strip.output->IsFastLED()) {
+        const uint32_t strip_start = micros();
+        auto e = strip.output->Show(this->frame_.data() + strip.first,
+                                    strip.count, stage, scale);
+        strip.time_us = micros() - strip_start;
+        if (e != NoError) {
+          result = e;
+        }
+      }
+    }
+  }
+
+  for (auto &strip : this->strips_) {
+    if (this->parallel_ && strip.output->IsFastLED()) {
+      continue;
+    }
+    const uint32_t strip_start = micros();
+    auto e = strip.output->Show(this->frame_.data() + strip.first, strip.count,
+                                stage, scale);
+    strip.time_us = micros() - strip_start;
+    if (e != NoError) {
+      result = e;
+    }
+  }
+
+  this->frame_time_us_ = micros() - start;
+  return result;
+}
+
+uint32_t MultiStripController::GetStripCount() const {
+  return static_cast<uint32_t>(this->strips_.size());
+}
+
+uint32_t MultiStripController::GetStripTime(uint32_t strip) const {
+  if (strip >= this->strips_.size()) {
+    return 0;
+  }
+  return this->strips_[strip].time_us;
+}
+
+uint32_t MultiStripController::GetFrameTime() const {
+  return this->frame_time_us_;
+}
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
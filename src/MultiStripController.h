@@ -0,0 +1,385 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_MULTISTRIPCONTROLLER_H
+#define LIGHTSHOW_MULTISTRIPCONTROLLER_H
+
+#include "LightShow.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <memory>
+#include <vector>
+
+#include "Controller.h"
+#include "Pixel.h"
+#include "StaticController.h"
+
+namespace LightShow {
+
+/**
+ * one physical strip driven by a MultiStripController
+ *
+ * This wraps a StaticController backend, so that strips of different types
+ * can be driven by the same controller.
+ */
+class StripOutput {
+ public:
+  virtual ~StripOutput() = default;
+
+  /**
+   * Start the strip
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  virtual Error Begin(Pixel *frame, uint32_t count) = 0;
+
+  /**
+   * Push a frame to the strip
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @param stage the corrections to apply, or nullptr for none
+   * @param scale the power limit scale, 255 for none
+   * @return 0 on success or a LightShow::Error on error
+   */
+  virtual Error Show(const Pixel *frame, uint32_t count,
+                     const OutputStage *stage, uint8_t scale) = 0;
+
+  /**
+   * check whether this strip is driven by FastLED
+   * @return true for a FastLED strip, else false
+   */
+  virtual bool IsFastLED() const { return false; }
+};
+
+/**
+ * a StripOutput that pushes frames through a StaticController backend
+ * @tparam Backend the type that pushes frames to the strip
+ */
+template <class Backend>
+class BackendStripOutput : public StripOutput {
+ public:
+  /**
+   * Create a strip output
+   * @param backend the object that pushes frames to the strip
+   */
+  explicit BackendStripOutput(Backend backend) : backend_(backend) {}
+
+  /**
+   * Start the strip
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Begin(Pixel *frame, uint32_t count) override {
+    return this->backend_.Begin(frame, count);
+  }
+
+  /**
+   * Push a frame to the strip
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @param stage the corrections to apply, or nullptr for none
+   * @param scale the power limit scale, 255 for none
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Show(const Pixel *frame, uint32_t count, const OutputStage *stage,
+             uint8_t scale) override {
+    return this->backend_.Show(frame, count, stage, scale);
+  }
+
+ protected:
+  /// the object that pushes frames to the strip
+  Backend backend_;
+};
+
+#if LIGHTSHOW_FASTLED_ENABLE == 1
+
+/**
+ * a StripOutput for a FastLED strip, which can be pushed together with the
+ * controller's other FastLED strips
+ * @tparam PIN the pin that drives the strip
+ */
+template <uint8_t PIN>
+class BackendStripOutput<FastLEDBackend<PIN>> : public StripOutput {
+ public:
+  /**
+   * Create a strip output
+   * @param backend the object that pushes frames to the strip
+   */
+  explicit BackendStripOutput(FastLEDBackend<PIN> backend)
+      : backend_(backend) {}
+
+  /**
+   * Register the strip with FastLED
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Begin(Pixel *frame, uint32_t count) override {
+    return this->backend_.Begin(frame, count);
+  }
+
+  /**
+   * Push a frame to this strip alone
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @param stage the corrections to apply, or nullptr for none
+   * @param scale the power limit scale, 255 for none
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Show(const Pixel *frame, uint32_t count, const OutputStage *stage,
+             uint8_t scale) override {
+    return this->backend_.Show(frame, count, stage, scale);
+  }
+
+  /**
+   * check whether this strip is driven by FastLED
+   * @return true
+   */
+  bool IsFastLED() const override { return true; }
+
+ protected:
+  /// the object that pushes frames to the strip
+  FastLEDBackend<PIN> backend_;
+};
+
+#endif  // LIGHTSHOW_FASTLED_ENABLE
+
+/**
+ * a controller that drives several physical strips as one
+ *
+ * Pixels are held in one contiguous frame, and each strip is given the next
+ * run of pixels in the order that it is added, so the first strip starts at
+ * logical index 0.  Strips are pushed through the same backends as
+ * StaticController: FastLEDBackend<PIN>, NeoPixelBackend or NullBackend.
+ *
+ * With parallel output turned on, the controller's FastLED strips are pushed
+ * back to back, ahead of its other strips.  This only orders the pushes; no
+ * parallel output API is driven.  A FastLED driver that batches the strips
+ * pushed to it, such as the ESP32 I2S driver, may then send them together,
+ * but with any other driver the strips are sent one after another, just as
+ * without parallel output.  Only this controller's strips are pushed, never
+ * the rest of the sketch's FastLED strips, and each is scaled by its own
+ * controller.
+ */
+class MultiStripController final : public Controller {
+ public:
+  /**
+   * Create a multi-strip controller
+   * @param num the total number of led's across every strip
+   */
+  explicit MultiStripController(uint32_t num);
+
+  /**
+   * Add a strip, driving the next count pixels of the frame
+   * @tparam Backend the type that pushes frames to the strip
+   * @param count the number of pixels in the strip
+   * @param backend the object that pushes frames to the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  template <class Backend>
+  Error AddStrip(uint32_t count, Backend backend = Backend()) {
+    return this->AddStrip(
+        count, std::unique_ptr<StripOutput>(
+                   new BackendStripOutput<Backend>(backend)));
+  }
+
+  /**
+   * Push the FastLED strips back to back, ahead of the other strips
+   * This only orders the pushes, for a FastLED driver that batches the strips
+   * pushed to it; with any other driver it is the same as serial output.
+   * @param parallel true to push FastLED strips back to back, false to push
+   * every strip in the order it was added
+   */
+  void SetParallelOutput(bool parallel);
+
+  /**
+   * Begin fading to a color
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Begin crossfading to a frame
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param target the color to fade each LED to, count long
+   * @param count the number of LEDs in target
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                       uint32_t count) override;
+
+  /**
+   * Set all LEDs to a color
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetLEDs(uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Set a single LED to a color
+   * @param i the logical index of the LED to set (0-indexed)
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Set a run of LEDs to a color
+   * @param first the index of the first LED to set (0-indexed)
+   * @param count the number of LEDs to set
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetRange(uint32_t first, uint32_t count, uint8_t r, uint8_t g,
+                 uint8_t b) override;
+
+  /**
+   * Copy a run of pixels onto the LEDs
+   * @param first the index of the first LED to set (0-indexed)
+   * @param src the pixels to copy, count long
+   * @param count the number of pixels to copy
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Blit(uint32_t first, const Pixel *src, uint32_t count) override;
+
+  /**
+   * Read back a run of LEDs
+   * @param first the index of the first LED to read (0-indexed)
+   * @param dst where to copy the pixels, count long
+   * @param count the number of pixels to read
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error GetFrame(uint32_t first, Pixel *dst, uint32_t count) const override;
+
+  /**
+   * return how many strips have been added
+   * @return the number of strips
+   */
+  uint32_t GetStripCount() const;
+
+  /**
+   * return how long the last update spent pushing one strip
+   * @param strip the index of the strip, in the order it was added
+   * @return the time in microseconds, or 0 if there is no such strip
+   */
+  uint32_t GetStripTime(uint32_t strip) const;
+
+  /**
+   * return how long the last update took
+   * @return the time in microseconds
+   */
+  uint32_t GetFrameTime() const;
+
+ protected:
+  /**
+   * push the frame to every strip
+   * Each strip is timed, as is the update as a whole.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Transmit() override;
+
+  /// a physical strip and the part of the frame that it shows
+  struct Strip {
+    /// the logical index of the first pixel of the strip
+    uint32_t first;
+
+    /// the number of pixels in the strip
+    uint32_t count;
+
+    /// the time taken to push the strip during the last update
+    uint32_t time_us;
+
+    /// the object that pushes frames to the strip
+    std::unique_ptr<StripOutput> output;
+  };
+
+  /**
+   * Add a strip, driving the next count pixels of the frame
+   * @param count the number of pixels in the strip
+   * @param output the object that pushes frames to the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error AddStrip(uint32_t count, std::unique_ptr<StripOutput> output);
+
+  /**
+   * Render and push one frame of the running fade
+   * @param weight the progress made across the fade in Q8 fixed point, 0 to
+   * kLerpOne
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error RenderFade(uint16_t weight) override;
+
+  /**
+   * Set and push the fade target once the fade has completed
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error EndFade() override;
+
+  /// the pixels of every strip, in logical order
+  std::vector<Pixel> frame_;
+
+  /// a snapshot of frame_ at the start of the running fade
+  std::vector<Pixel> fade_from_;
+
+  /// the color that the running fade is heading towards
+  Pixel fade_to_;
+
+  /// the frame that the running crossfade is heading towards, allocated by
+  /// the first crossfade
+  std::vector<Pixel> fade_target_;
+
+  /// the strips, in the order they were added
+  std::vector<Strip> strips_;
+
+  /// the number of pixels already given to a strip
+  uint32_t assigned_ = 0;
+
+  /// true if FastLED strips are pushed back to back, ahead of the others
+  bool parallel_ = false;
+
+  /// the time taken by the last update
+  uint32_t frame_time_us_ = 0;
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
+
+#endif  // LIGHTSHOW_MULTISTRIPCONTROLLER_H
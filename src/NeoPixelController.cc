@@ -25,17 +25,99 @@
 
 #include "NeoPixelController.h"
 
-#if LIGHTSHOW_NEOPIXEL_ENABLE == 1
+#include <algorithm>
+#include <cstddef>
+
+#if LIGHTSHOW_NEOPIXEL_ENABLE == 1 && LIGHTSHOW_NO_HEAP != 1
 
 namespace LightShow {
 
+namespace {
+
+/**
+ * write a pixel, if it differs from the value already stored
+ * @tparam Stride the number of bytes per pixel
+ * @param pixel the pixel to write
+ * @param p the new value of the pixel
+ * @return true if the pixel changed, else false
+ */
+template <uint8_t Stride>
+inline bool StorePixel(uint8_t *pixel, const uint8_t *p) {
+  if (memcmp(pixel, p, Stride) == 0) {
+    return false;
+  }
+  memcpy(pixel, p, Stride);
+  return true;
+}
+
+/**
+ * set every pixel in a buffer to the same value
+ * @tparam Stride the number of bytes per pixel
+ * @param frame the pixels to write
+ * @param count the number of pixels in frame
+ * @param p the new value of every pixel
+ * @param first set to the index of the first changed pixel, if any
+ * @param last set to the index one past the last changed pixel, if any
+ */
+template <uint8_t Stride>
+void FillPixels(uint8_t *frame, uint32_t count, const uint8_t *p,
+                uint32_t *first, uint32_t *last) {
+  for (uint32_t i = 0; i < count; i++, frame += Stride) {
+    if (StorePixel<Stride>(frame, p)) {
+      if (*first > i) {
+        *first = i;
+      }
+      *last = i + 1;
+    }
+  }
+}
+
+/**
+ * add up the channels of a pixel
+ * @param p the pixel
+ * @param stride the number of bytes per pixel
+ * @return the sum of its channels
+ */
+inline uint32_t SumPixel(const uint8_t *p, uint8_t stride) {
+  return p[0] + p[1] + p[2] + ((stride == 4) ? p[3] : 0);
+}
+
+}  // namespace
+
 NeoPixelController::NeoPixelController(uint16_t n, int16_t pin,
                                        neoPixelType type)
-    : num_pixels_(n) {
+    : num_pixels_(n), dirty_first_(0), dirty_last_(n) {
   this->neopixel_ = std::unique_ptr<Adafruit_NeoPixel>(
       new Adafruit_NeoPixel(this->num_pixels_, pin, type));
+  this->CountAllocations(1);
+#if LIGHTSHOW_NEOPIXEL_ZEROCOPY == 1
+  // pixels are stored in the strip's native order, as decoded from the
+  // NEO_* type constant
+  this->offsets_[0] = (type >> 4) & 0x03;
+  this->offsets_[1] = (type >> 2) & 0x03;
+  this->offsets_[2] = type & 0x03;
+  this->offsets_[3] = (type >> 6) & 0x03;
+  this->stride_ = (this->offsets_[3] == this->offsets_[0]) ? 3 : 4;
+  this->frame_ = this->neopixel_->getPixels();
+  if (this->frame_ == nullptr) {
+    // the library could not allocate its buffer, so there is nothing to set
+    this->num_pixels_ = 0;
+    this->dirty_last_ = 0;
+  }
+#else
   this->pixels_ = std::vector<SingleNeoPixel>(n);
+  this->CountAllocations(1);
+  this->offsets_[0] = offsetof(SingleNeoPixel, r);
+  this->offsets_[1] = offsetof(SingleNeoPixel, g);
+  this->offsets_[2] = offsetof(SingleNeoPixel, b);
+  this->offsets_[3] = offsetof(SingleNeoPixel, w);
+  this->stride_ = sizeof(SingleNeoPixel);
+  this->frame_ = reinterpret_cast<uint8_t *>(this->pixels_.data());
+#endif
+  this->fade_from_ = std::vector<uint8_t>(this->num_pixels_ * this->stride_);
+  this->CountAllocations(1);
   this->neopixel_->begin();
+  this->TrackPower(this->num_pixels_);
 }
 
 NeoPixelController::~NeoPixelController() { this->Stop(0); }
@@ -43,8 +125,8 @@ NeoPixelController::~NeoPixelController() { this->Stop(0); }
 Error NeoPixelController::Fade(uint32_t fade_ms, uint32_t c) {
   return this->Fade(fade_ms,
                     static_cast<uint8_t>((c & 0xFF0000) >> 16),     // r
-                    static_cast<uint8_t>((c & 0xFF0000) >> 16),     // g
-                    static_cast<uint8_t>((c & 0xFF0000) >> 8),      // b
+                    static_cast<uint8_t>((c & 0xFF00) >> 8),        // g
+                    static_cast<uint8_t>(c & 0xFF),                 // b
                     static_cast<uint8_t>((c & 0xFF000000) >> 24));  // w
 }
 
@@ -54,105 +136,235 @@ Error NeoPixelController::Fade(uint32_t fade_ms, SingleNeoPixel p) {
 
 Error NeoPixelController::Fade(uint32_t fade_ms, uint8_t r, uint8_t g,
                                uint8_t b, uint8_t w) {
-  const auto start_time = millis();
-  auto now = start_time;
-
-  // progressively inch the neopixel_ strip closer to the target value
-  do {
-    // determine the percentage of progress made across fade_ms 0.0-1.0
-    auto scale =
-        static_cast<float>(now - start_time) / static_cast<float>(fade_ms);
-
-    // for each pixel, set it to some approximate value between starting and
-    // ending values in proportion to the calculated scale
-    for (uint32_t i = 0; i < this->num_pixels_; i++) {
-      // don't use SetLED, as we are calculating the difference in-place and
-      // will update that at the end
-      this->neopixel_->setPixelColor(
-          i,
-          this->pixels_[i].r +
-              static_cast<uint8_t>(
-                  (static_cast<float>(r - this->pixels_[i].r) * scale)),
-          this->pixels_[i].g +
-              static_cast<uint8_t>(
-                  (static_cast<float>(g - this->pixels_[i].g) * scale)),
-          this->pixels_[i].b +
-              static_cast<uint8_t>(
-                  (static_cast<float>(b - this->pixels_[i].b) * scale)),
-          this->pixels_[i].w +
-              static_cast<uint8_t>(
-                  (static_cast<float>(w - this->pixels_[i].w) * scale)));
-    }
-    this->neopixel_->show();
+  auto e = this->BeginFade(fade_ms, r, g, b, w);
+  if (e != NoError) {
+    return e;
+  }
+  return this->AwaitFade();
+}
 
-    // recalculate the current time, and keep going until we hit our target
-    // fade_ms
-  } while ((now = millis()) < start_time + fade_ms);
+Error NeoPixelController::BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g,
+                                    uint8_t b, uint8_t w) {
+  std::copy(this->frame_, this->frame_ + this->fade_from_.size(),
+            this->fade_from_.begin());
+  this->EncodePixel(r, g, b, w, this->fade_to_);
+  this->StartFade(fade_ms,
+                  this->num_pixels_ * SumPixel(this->fade_to_, this->stride_));
+  return NoError;
+}
 
-  // update our local neopixel_ definitions and perform a final update
-  this->SetLEDs(r, g, b, w);
-  this->Update();
+Error NeoPixelController::BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                                         uint32_t count) {
+  uint32_t first = 0;
+  const Error e = ClipRange(this->num_pixels_, &first, &count);
+  const size_t len = this->fade_from_.size();
+  if (this->fade_target_.empty()) {
+    this->fade_target_.resize(len);
+    this->CountAllocations(1);
+  }
+  std::copy(this->frame_, this->frame_ + len, this->fade_from_.begin());
+  std::copy(this->frame_, this->frame_ + len, this->fade_target_.begin());
+  // the target is encoded once here, so that each frame is a plain lerp
+  uint8_t *run = this->fade_target_.data();
+  for (uint32_t i = 0; i < count; i++, run += this->stride_) {
+    this->EncodePixel(target[i].r, target[i].g, target[i].b, 0x00, run);
+  }
+  this->StartFade(fade_ms, SumBuffer(this->fade_target_.data(), len), true);
+  return e;
+}
 
-  return NoError;
+Error NeoPixelController::RenderFade(uint16_t weight) {
+  // move every channel of every pixel from its starting value towards the
+  // target in proportion to weight
+  if (this->IsCrossFade()) {
+    LerpBuffer(this->frame_, this->fade_from_.data(),
+               this->fade_target_.data(), this->fade_from_.size(), weight);
+  } else {
+    LerpToColor(this->frame_, this->fade_from_.data(), this->fade_from_.size(),
+                this->fade_to_, this->stride_, weight);
+  }
+  this->MarkDirty(0, this->num_pixels_);
+  return this->Update();
+}
+
+Error NeoPixelController::EndFade() {
+  // land exactly on the target and perform a final update
+  return this->RenderFade(kLerpOne);
 }
 
-Error NeoPixelController::Update() {
-  for (auto i = 0; i < this->neopixel_->numPixels(); i++) {
-    this->neopixel_->setPixelColor(i, this->pixels_[i].c);
+Error NeoPixelController::Transmit() {
+#if LIGHTSHOW_NEOPIXEL_ZEROCOPY == 1
+  if (this->frame_ == nullptr) {
+    return NoLEDStripConnected;
+  }
+#endif
+
+  // nothing has changed, so there is nothing to push
+  if (this->dirty_first_ >= this->dirty_last_) {
+    return NoError;
+  }
+
+#if LIGHTSHOW_NEOPIXEL_ZEROCOPY != 1
+  const OutputStage *stage = this->GetOutputStage();
+  const uint8_t scale = this->GetPowerScale();
+  if (stage == nullptr && scale == 0xFF) {
+    for (auto i = this->dirty_first_; i < this->dirty_last_; i++) {
+      this->neopixel_->setPixelColor(i, this->pixels_[i].c);
+    }
+  } else {
+    for (auto i = this->dirty_first_; i < this->dirty_last_; i++) {
+      auto p = this->pixels_[i];
+      if (stage != nullptr) {
+        p.r = stage->GetTable(0)[p.r];
+        p.g = stage->GetTable(1)[p.g];
+        p.b = stage->GetTable(2)[p.b];
+      }
+      this->neopixel_->setPixelColor(i, Scale8(p.r, scale), Scale8(p.g, scale),
+                                     Scale8(p.b, scale), Scale8(p.w, scale));
+    }
   }
+#endif
   this->neopixel_->show();
 
+  this->dirty_first_ = this->num_pixels_;
+  this->dirty_last_ = 0;
   return NoError;
 }
 
+void NeoPixelController::OnOutputChanged() {
+  this->MarkDirty(0, this->num_pixels_);
+}
+
+void NeoPixelController::MarkDirty(uint32_t first, uint32_t last) {
+  if (first < this->dirty_first_) {
+    this->dirty_first_ = first;
+  }
+  if (last > this->dirty_last_) {
+    this->dirty_last_ = last;
+  }
+}
+
 Error NeoPixelController::Fade(uint32_t fade_ms, uint8_t r, uint8_t g,
                                uint8_t b) {
   return this->Fade(fade_ms, r, g, b, 0);
 }
 
+Error NeoPixelController::BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g,
+                                    uint8_t b) {
+  return this->BeginFade(fade_ms, r, g, b, 0);
+}
+
 Error NeoPixelController::SetLEDs(uint8_t r, uint8_t g, uint8_t b) {
-  for (auto &item : this->pixels_) {
-    item.r = r;
-    item.g = g;
-    item.b = b;
-    item.w = 0x00;
-  }
-  return NoError;
+  return this->SetLEDs(r, g, b, 0x00);
 }
 
 Error NeoPixelController::SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) {
-  if (i > this->num_pixels_) {
-    return LEDIndexOutOfRange;
-  }
-  this->pixels_[i].r = r;
-  this->pixels_[i].g = g;
-  this->pixels_[i].b = b;
-  this->pixels_[i].w = 0x00;
-  return NoError;
+  return this->SetLED(i, r, g, b, 0x00);
 }
 
 Error NeoPixelController::SetLEDs(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
-  for (auto &item : this->pixels_) {
-    item.r = r;
-    item.g = g;
-    item.b = b;
-    item.w = w;
+  uint8_t p[4];
+  this->EncodePixel(r, g, b, w, p);
+
+  // only the span between the first and last changed pixel needs pushing
+  uint32_t first = this->num_pixels_;
+  uint32_t last = 0;
+  if (this->stride_ == 4) {
+    FillPixels<4>(this->frame_, this->num_pixels_, p, &first, &last);
+  } else {
+    FillPixels<3>(this->frame_, this->num_pixels_, p, &first, &last);
   }
+  this->MarkDirty(first, last);
+  this->TrackFrame(this->num_pixels_ * SumPixel(p, this->stride_));
   return NoError;
 }
 
 Error NeoPixelController::SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b,
                                  uint8_t w) {
-  if (i > this->num_pixels_) {
+  if (i >= this->num_pixels_) {
     return LEDIndexOutOfRange;
   }
-  this->pixels_[i].r = r;
-  this->pixels_[i].g = g;
-  this->pixels_[i].b = b;
-  this->pixels_[i].w = w;
+  uint8_t p[4];
+  this->EncodePixel(r, g, b, w, p);
+  uint8_t *pixel = this->frame_ + i * this->stride_;
+  this->TrackPixel(SumPixel(pixel, this->stride_), SumPixel(p, this->stride_));
+  const bool changed = (this->stride_ == 4) ? StorePixel<4>(pixel, p)
+                                            : StorePixel<3>(pixel, p);
+  if (changed) {
+    this->MarkDirty(i, i + 1);
+  }
   return NoError;
 }
 
+Error NeoPixelController::SetRange(uint32_t first, uint32_t count, uint8_t r,
+                                   uint8_t g, uint8_t b) {
+  const Error e = ClipRange(this->num_pixels_, &first, &count);
+  uint8_t p[4];
+  this->EncodePixel(r, g, b, 0x00, p);
+  uint8_t *run = this->frame_ + first * this->stride_;
+  this->TrackPixel(SumBuffer(run, count * this->stride_),
+                   count * SumPixel(p, this->stride_));
+
+  // only the span between the first and last changed pixel needs pushing
+  uint32_t changed_first = count;
+  uint32_t changed_last = 0;
+  if (this->stride_ == 4) {
+    FillPixels<4>(run, count, p, &changed_first, &changed_last);
+  } else {
+    FillPixels<3>(run, count, p, &changed_first, &changed_last);
+  }
+  if (changed_first < changed_last) {
+    this->MarkDirty(first + changed_first, first + changed_last);
+  }
+  return e;
+}
+
+Error NeoPixelController::Blit(uint32_t first, const Pixel *src,
+                               uint32_t count) {
+  const Error e = ClipRange(this->num_pixels_, &first, &count);
+  uint8_t *run = this->frame_ + first * this->stride_;
+  this->TrackPixel(
+      SumBuffer(run, count * this->stride_),
+      SumBuffer(reinterpret_cast<const uint8_t *>(src), count * sizeof(Pixel)));
+  for (uint32_t i = 0; i < count; i++, run += this->stride_) {
+    this->EncodePixel(src[i].r, src[i].g, src[i].b, 0x00, run);
+  }
+  if (count > 0) {
+    this->MarkDirty(first, first + count);
+  }
+  return e;
+}
+
+Error NeoPixelController::GetFrame(uint32_t first, Pixel *dst,
+                                   uint32_t count) const {
+  const Error e = ClipRange(this->num_pixels_, &first, &count);
+  const uint8_t *run = this->frame_ + first * this->stride_;
+  for (uint32_t i = 0; i < count; i++, run += this->stride_) {
+    dst[i].r = run[this->offsets_[0]];
+    dst[i].g = run[this->offsets_[1]];
+    dst[i].b = run[this->offsets_[2]];
+  }
+  return e;
+}
+
+#if LIGHTSHOW_NEOPIXEL_ZEROCOPY == 1
+Error NeoPixelController::SetPowerBudget(uint32_t milliamps) {
+  if (milliamps != 0) {
+    return PowerLimitUnsupported;
+  }
+  return Controller::SetPowerBudget(milliamps);
+}
+#endif
+
+void NeoPixelController::EncodePixel(uint8_t r, uint8_t g, uint8_t b,
+                                     uint8_t w, uint8_t *out) const {
+  // white goes first, as RGB strips share its offset with red
+  out[this->offsets_[3]] = w;
+  out[this->offsets_[0]] = r;
+  out[this->offsets_[1]] = g;
+  out[this->offsets_[2]] = b;
+}
+
 }  // namespace LightShow
 
-#endif  // LIGHTSHOW_NEOPIXEL_ENABLE
+#endif  // LIGHTSHOW_NEOPIXEL_ENABLE && !LIGHTSHOW_NO_HEAP
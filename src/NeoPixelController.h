@@ -28,7 +28,7 @@
 
 #include "Controller.h"
 
-#if LIGHTSHOW_NEOPIXEL_ENABLE == 1
+#if LIGHTSHOW_NEOPIXEL_ENABLE == 1 && LIGHTSHOW_NO_HEAP != 1
 
 #include <Arduino.h>
 
@@ -70,11 +70,19 @@ union SingleNeoPixel {
   };
 };
 
-class NeoPixelController : public Controller {
+class NeoPixelController final : public Controller {
  public:
   /**
    * Create NeoPixel-based Controller by initializing a new NeoPixel
    * object. The NeoPixel strip will be created and begin() will be called.
+   *
+   * When LIGHTSHOW_NEOPIXEL_ZEROCOPY is set, pixels are written straight into
+   * the NeoPixel library's buffer in the strip's native color order, which
+   * saves a copy of every pixel.  Brightness set on the underlying NeoPixel
+   * object is not applied in this mode, and neither is an output stage or a
+   * power budget.  If the NeoPixel library cannot
+   * allocate its buffer, the controller has no pixels and Update() returns
+   * NoLEDStripConnected.
    * @param n Number of NeoPixels in strand.
    * @param p Arduino pin number which will drive the NeoPixel data in.
    * @param t Pixel type -- add together NEO_* constants defined in
@@ -102,6 +110,29 @@ class NeoPixelController : public Controller {
    */
   Error Fade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) override;
 
+  /**
+   * Begin fading to black, or another hue.
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Begin crossfading to a frame
+   * This is a non-blocking operation.  Call Loop() to advance the fade.  The
+   * white channel of each LED in target fades to 0.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param target the color to fade each LED to, count long
+   * @param count the number of LEDs in target
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                       uint32_t count) override;
+
   /**
    * Set all LEDs to a color
    * @param r Red brightness, 0 to 255.
@@ -122,12 +153,71 @@ class NeoPixelController : public Controller {
   Error SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) override;
 
   /**
-   * reads the local pixel values and pushing them to the NeoPixel
+   * Set a run of LEDs to a color
+   * @param first the index of the first LED to set (0-indexed)
+   * @param count the number of LEDs to set
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
    * @return 0 on success or a LightShow::Error on error
    */
-  Error Update() override;
+  Error SetRange(uint32_t first, uint32_t count, uint8_t r, uint8_t g,
+                 uint8_t b) override;
+
+  /**
+   * Copy a run of pixels onto the LEDs
+   * @param first the index of the first LED to set (0-indexed)
+   * @param src the pixels to copy, count long
+   * @param count the number of pixels to copy
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Blit(uint32_t first, const Pixel *src, uint32_t count) override;
+
+  /**
+   * Read back a run of LEDs
+   * @param first the index of the first LED to read (0-indexed)
+   * @param dst where to copy the pixels, count long
+   * @param count the number of pixels to read
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error GetFrame(uint32_t first, Pixel *dst, uint32_t count) const override;
+
+#if LIGHTSHOW_NEOPIXEL_ZEROCOPY == 1
+  /**
+   * Refuse to limit the current drawn by the strip
+   * In zero-copy mode the frame is the NeoPixel buffer that goes to the wire,
+   * so there is no pass in which to scale it.
+   * @param milliamps the most current the strip may draw, or 0 for no limit
+   * @return 0 if milliamps is 0, else PowerLimitUnsupported
+   */
+  Error SetPowerBudget(uint32_t milliamps) override;
+#endif
 
  protected:
+  /**
+   * reads the local pixel values and pushing them to the NeoPixel
+   *
+   * Only pixels that changed since the last update are copied, and nothing is
+   * pushed at all if the frame is unchanged.  When LIGHTSHOW_NEOPIXEL_ZEROCOPY
+   * is set, pixels are already in the NeoPixel buffer and nothing is copied.
+   * Any output stage and power limit are applied as pixels are copied.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Transmit() override;
+
+  /**
+   * Push the whole frame next time, as the output of every pixel may change
+   */
+  void OnOutputChanged() override;
+
+#if LIGHTSHOW_NEOPIXEL_ZEROCOPY == 1
+  /**
+   * check whether the output stage is applied on the way to the wire
+   * @return false, as in zero-copy mode nothing is copied to apply it in
+   */
+  bool IsStageApplied() const override { return false; }
+#endif
+
   /**
    * Fade to a color
    * This is a blocking operation.
@@ -158,6 +248,33 @@ class NeoPixelController : public Controller {
    */
   Error Fade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b, uint8_t w);
 
+  /**
+   * Begin fading to a color
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @param w White brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b,
+                  uint8_t w);
+
+  /**
+   * Render and push one frame of the running fade
+   * @param weight the progress made across the fade in Q8 fixed point, 0 to
+   * kLerpOne
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error RenderFade(uint16_t weight) override;
+
+  /**
+   * Set and push the fade target once the fade has completed
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error EndFade() override;
+
   /**
    * Set all LEDs to a color
    * @param r Red brightness, 0 to 255.
@@ -179,18 +296,72 @@ class NeoPixelController : public Controller {
    */
   Error SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b, uint8_t w);
 
+  /**
+   * Record that a range of pixels has changed since the last update
+   * @param first the index of the first changed pixel
+   * @param last the index one past the last changed pixel
+   */
+  void MarkDirty(uint32_t first, uint32_t last);
+
+  /**
+   * Arrange a color in the byte order used by frame_
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @param w White brightness, 0 to 255.
+   * @param out the stride_ bytes to write
+   */
+  void EncodePixel(uint8_t r, uint8_t g, uint8_t b, uint8_t w,
+                   uint8_t *out) const;
+
   /// internal NeoPixel object
   std::unique_ptr<Adafruit_NeoPixel> neopixel_;
 
+#if LIGHTSHOW_NEOPIXEL_ZEROCOPY != 1
   /// a buffer containing the known state of pixels_
   std::vector<SingleNeoPixel> pixels_;
+#endif
+
+  /**
+   * the pixel bytes that SetLED(), SetLEDs() and fades write to
+   *
+   * This points into pixels_, or straight into the NeoPixel library's own
+   * buffer when LIGHTSHOW_NEOPIXEL_ZEROCOPY is set.
+   */
+  uint8_t *frame_;
+
+  /// the number of bytes per pixel in frame_
+  uint8_t stride_;
+
+  /// the offsets of the red, green, blue and white bytes within a pixel
+  uint8_t offsets_[4];
 
   /// the known size of the NeoPixel strip, since it is frequently referenced
   uint32_t num_pixels_;
+
+  /// the index of the first pixel changed since the last update
+  uint32_t dirty_first_;
+
+  /// the index one past the last pixel changed since the last update
+  uint32_t dirty_last_;
+
+  /**
+   * a snapshot of frame_ at the start of the running fade
+   *
+   * This is allocated once by the constructor and reused by every fade.
+   */
+  std::vector<uint8_t> fade_from_;
+
+  /// the color that the running fade is heading towards, in frame_ order
+  uint8_t fade_to_[4];
+
+  /// the frame that the running crossfade is heading towards, in frame_
+  /// order, allocated by the first crossfade
+  std::vector<uint8_t> fade_target_;
 };
 
 }  // namespace LightShow
 
-#endif  // LIGHTSHOW_NEOPIXEL_ENABLE
+#endif  // LIGHTSHOW_NEOPIXEL_ENABLE && !LIGHTSHOW_NO_HEAP
 
 #endif  // LIGHTSHOW_NEOPIXELCONTROLLER_H
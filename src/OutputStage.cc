@@ -0,0 +1,91 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "OutputStage.h"
+
+#include "Lerp.h"
+
+namespace LightShow {
+
+void OutputStage::SetBrightness(uint8_t brightness) {
+  this->dirty_ |= brightness != this->brightness_;
+  this->brightness_ = brightness;
+}
+
+void OutputStage::SetGamma(Curve gamma) {
+  this->dirty_ |= gamma != this->gamma_;
+  this->gamma_ = gamma;
+}
+
+void OutputStage::SetWhitePoint(uint8_t r, uint8_t g, uint8_t b) {
+  const uint8_t white[3] = {r, g, b};
+  for (uint8_t c = 0; c < 3; c++) {
+    this->dirty_ |= white[c] != this->white_[c];
+    this->white_[c] = white[c];
+  }
+}
+
+uint8_t OutputStage::GetBrightness() const { return this->brightness_; }
+
+void OutputStage::Prepare() {
+  if (!this->dirty_) {
+    return;
+  }
+  this->dirty_ = false;
+  this->version_++;
+
+  // fold the white point and the brightness into one scale per channel
+  this->identity_ = this->gamma_ == Curve::Linear;
+  for (uint8_t c = 0; c < 3; c++) {
+    const uint8_t scale = Scale8(this->white_[c], this->brightness_);
+    this->identity_ = this->identity_ && scale == 0xFF;
+    const uint8_t *curve = GetCurveTable(this->gamma_);
+    for (uint16_t v = 0; v < 256; v++) {
+      this->tables_[c][v] = Scale8(pgm_read_byte(curve + v), scale);
+    }
+  }
+}
+
+bool OutputStage::IsIdentity() const { return this->identity_; }
+
+uint32_t OutputStage::GetVersion() const { return this->version_; }
+
+const uint8_t *OutputStage::GetTable(uint8_t channel) const {
+  return this->tables_[channel];
+}
+
+void OutputStage::Apply(const Pixel *src, Pixel *dst, uint32_t count) const {
+  const uint8_t *r = this->tables_[0];
+  const uint8_t *g = this->tables_[1];
+  const uint8_t *b = this->tables_[2];
+  for (uint32_t i = 0; i < count; i++) {
+    const Pixel p = src[i];
+    dst[i].r = r[p.r];
+    dst[i].g = g[p.g];
+    dst[i].b = b[p.b];
+  }
+}
+
+}  // namespace LightShow
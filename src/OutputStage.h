@@ -0,0 +1,139 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_OUTPUTSTAGE_H
+#define LIGHTSHOW_OUTPUTSTAGE_H
+
+#include <Arduino.h>
+
+#include "Curve.h"
+#include "Pixel.h"
+
+namespace LightShow {
+
+/**
+ * the corrections applied to each pixel on its way to the wire
+ *
+ * Gamma, white point and master brightness are folded into one 256-entry
+ * table per channel, so applying all three costs a single lookup per channel.
+ * The tables are rebuilt only when a setting changes, on the next update.
+ * Attach the stage to a controller with Controller::SetOutputStage(); several
+ * controllers may share one stage.  The frame that presets draw into is never
+ * changed, so fades and read-backs still work on the uncorrected colors.
+ * The tables take 768 bytes, over a third of the RAM of a 2 KB AVR part, so
+ * share one stage between controllers rather than giving each its own.
+ */
+class OutputStage {
+ public:
+  /**
+   * Create a stage that passes every pixel through unchanged
+   */
+  OutputStage() = default;
+
+  /**
+   * Set the master brightness
+   * @param brightness the scale applied to every channel, 0 to 255
+   */
+  void SetBrightness(uint8_t brightness);
+
+  /**
+   * Set the gamma curve
+   * @param gamma the curve that maps each channel to its output, such as
+   * Curve::Gamma22, or Curve::Linear for none
+   */
+  void SetGamma(Curve gamma);
+
+  /**
+   * Set the white point, as the output of each channel at full white
+   * @param r red 0-255
+   * @param g green 0-255
+   * @param b blue 0-255
+   */
+  void SetWhitePoint(uint8_t r, uint8_t g, uint8_t b);
+
+  /**
+   * return the master brightness
+   * @return the scale applied to every channel, 0 to 255
+   */
+  uint8_t GetBrightness() const;
+
+  /**
+   * Rebuild the tables, if any setting has changed since they were built
+   */
+  void Prepare();
+
+  /**
+   * check whether the stage passes every pixel through unchanged
+   * @return true if the tables are the identity, else false
+   */
+  bool IsIdentity() const;
+
+  /**
+   * return how many times the tables have been rebuilt
+   * @return a number that changes whenever the tables do
+   */
+  uint32_t GetVersion() const;
+
+  /**
+   * return the table for one channel
+   * @param channel 0 for red, 1 for green, 2 for blue
+   * @return 256 output values, indexed by the value in the frame
+   */
+  const uint8_t *GetTable(uint8_t channel) const;
+
+  /**
+   * Correct a run of pixels
+   * @param src the pixels to correct
+   * @param dst where to write the corrected pixels (may be the same as src)
+   * @param count the number of pixels
+   */
+  void Apply(const Pixel *src, Pixel *dst, uint32_t count) const;
+
+ private:
+  /// the output of each channel, by the value in the frame
+  uint8_t tables_[3][256];
+
+  /// the master brightness
+  uint8_t brightness_ = 0xFF;
+
+  /// the gamma curve
+  Curve gamma_ = Curve::Linear;
+
+  /// the output of each channel at full white
+  uint8_t white_[3] = {0xFF, 0xFF, 0xFF};
+
+  /// true if a setting has changed since the tables were built
+  bool dirty_ = true;
+
+  /// true if the tables are the identity
+  bool identity_ = true;
+
+  /// the number of times the tables have been rebuilt
+  uint32_t version_ = 0;
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_OUTPUTSTAGE_H
@@ -0,0 +1,55 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_PIXEL_H
+#define LIGHTSHOW_PIXEL_H
+
+#include <Arduino.h>
+
+namespace LightShow {
+
+/**
+ * a single pixel in red, green, blue order
+ *
+ * This is the backend-neutral pixel format used to pass whole frames around.
+ * It has the same layout as FastLED's CRGB.
+ */
+struct Pixel {
+  /// red 0-255
+  uint8_t r;
+  /// green 0-255
+  uint8_t g;
+  /// blue 0-255
+  uint8_t b;
+};
+
+/**
+ * the order in which a source sends the channels of each pixel
+ */
+enum class ColorOrder : uint8_t { RGB, RBG, GRB, GBR, BRG, BGR };
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_PIXEL_H
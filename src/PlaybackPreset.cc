@@ -0,0 +1,277 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "PlaybackPreset.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <string.h>
+
+#include <utility>
+
+#include "Controller.h"
+
+namespace LightShow {
+
+namespace {
+
+/**
+ * read a little-endian 32-bit number
+ * @param p the first byte
+ * @return the number
+ */
+uint32_t ReadLE32(const uint8_t *p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+}  // namespace
+
+PlaybackPreset::PlaybackPreset(std::shared_ptr<Controller> controller,
+                               FrameSource *source)
+    : controller_(std::move(controller)), source_(source) {}
+
+Error PlaybackPreset::Start() {
+  this->start_ms_ = millis();
+  return this->ReadHeader();
+}
+
+Error PlaybackPreset::Loop() {
+  this->controller_->BeginRender();
+  if (this->frame_count_ == 0) {
+    return NoError;
+  }
+
+  // the number of frames that should have been shown by now
+  uint32_t due = this->next_frame_ + 1;
+  if (this->frame_ms_ != 0) {
+    due = (millis() - this->start_ms_) / this->frame_ms_ + 1;
+  }
+
+  while (this->next_frame_ < due) {
+    if (this->next_frame_ >= this->frame_count_) {
+      if (!this->repeat_) {
+        break;
+      }
+      // skip any laps that were missed entirely, then start over
+      const uint32_t laps = (due - 1) / this->frame_count_;
+      due -= laps * this->frame_count_;
+      this->start_ms_ += laps * this->frame_count_ * this->frame_ms_;
+      auto e = this->ReadHeader();
+      if (e != NoError) {
+        return e;
+      }
+      continue;
+    }
+    auto e = this->DecodeFrame();
+    if (e != NoError) {
+      return e;
+    }
+  }
+
+  if (!this->changed_) {
+    return NoError;
+  }
+  this->changed_ = false;
+  return this->PushFrame(this->controller_.get());
+}
+
+void PlaybackPreset::SetRepeat(bool repeat) { this->repeat_ = repeat; }
+
+uint32_t PlaybackPreset::GetPixelCount() const { return this->pixels_; }
+
+uint32_t PlaybackPreset::GetDecodedFrames() const {
+  return this->decoded_frames_;
+}
+
+uint32_t PlaybackPreset::GetDecodedBytes() const {
+  return this->decoded_bytes_;
+}
+
+uint32_t PlaybackPreset::GetDecodeTime() const { return this->decode_us_; }
+
+Error PlaybackPreset::ReadHeader() {
+  this->chunk_pos_ = 0;
+  this->chunk_len_ = 0;
+  this->run_count_ = 0;
+  this->next_frame_ = 0;
+  this->frame_count_ = 0;
+  if (!this->source_->Rewind()) {
+    return ShowFileInvalid;
+  }
+
+  uint8_t header[ShowFile::kHeaderLength];
+  if (this->Read(header, sizeof(header)) != sizeof(header) ||
+      memcmp(header, "LSF1", 4) != 0) {
+    return ShowFileInvalid;
+  }
+  this->pixels_ = ReadLE32(header + 4);
+  this->frame_count_ = ReadLE32(header + 8);
+  this->frame_ms_ = static_cast<uint16_t>(header[12] | (header[13] << 8));
+  return NoError;
+}
+
+Error PlaybackPreset::DecodeFrame() {
+  const uint32_t start = micros();
+  uint8_t head[ShowFile::kFrameHeaderLength];
+  if (this->Read(head, sizeof(head)) != sizeof(head)) {
+    return ShowFileInvalid;
+  }
+  uint32_t left = ReadLE32(head + 1);
+  this->decoded_bytes_ += sizeof(head) + left;
+
+  const uint32_t total = this->pixels_ * sizeof(Pixel);
+  uint32_t pos = 0;
+  if (head[0] == ShowFile::kFrameKey) {
+    // a keyframe is XORed over black; if the show is longer than the strip,
+    // the pixels that fit are still set
+    this->controller_->SetRange(0, this->pixels_, 0, 0, 0);
+    this->changed_ = true;
+  }
+
+  while (left > 0) {
+    if (this->chunk_pos_ == this->chunk_len_ && !this->Refill()) {
+      return ShowFileInvalid;
+    }
+    const uint8_t token = this->chunk_[this->chunk_pos_++];
+    --left;
+    if (token < ShowFile::kLiteral) {
+      pos += token + 1u;
+      continue;
+    }
+
+    uint32_t n = (token & 0x3F) + 1u;
+    if (token >= ShowFile::kRepeat) {
+      // one pixel of XOR, repeated
+      if (left < sizeof(Pixel) || pos + n * sizeof(Pixel) > total) {
+        return ShowFileInvalid;
+      }
+      left -= sizeof(Pixel);
+      uint8_t d[sizeof(Pixel)];
+      if (this->Read(d, sizeof(d)) != sizeof(d)) {
+        return ShowFileInvalid;
+      }
+      for (uint32_t i = 0; i < n; i++, pos += sizeof(Pixel)) {
+        this->Xor(pos, d, sizeof(d));
+      }
+      continue;
+    }
+
+    if (n > left || pos + n > total) {
+      return ShowFileInvalid;
+    }
+    left -= n;
+    // XOR straight out of the chunk buffer, a chunk at a time
+    while (n > 0) {
+      if (this->chunk_pos_ == this->chunk_len_ && !this->Refill()) {
+        return ShowFileInvalid;
+      }
+      uint32_t take = this->chunk_len_ - this->chunk_pos_;
+      if (take > n) {
+        take = n;
+      }
+      this->Xor(pos, this->chunk_ + this->chunk_pos_, take);
+      this->chunk_pos_ += take;
+      pos += take;
+      n -= take;
+    }
+  }
+
+  this->FlushRun();
+  ++this->next_frame_;
+  ++this->decoded_frames_;
+  this->decode_us_ += micros() - start;
+  return NoError;
+}
+
+void PlaybackPreset::Xor(uint32_t pos, const uint8_t *in, uint32_t len) {
+  while (len > 0) {
+    // frames change pixels in order, so within a frame the run only ever
+    // moves forwards
+    const uint32_t pixel = pos / sizeof(Pixel);
+    if (this->run_count_ == 0 ||
+        pixel >= this->run_first_ + this->run_count_) {
+      this->FlushRun();
+      this->run_first_ = pixel;
+      this->run_count_ = this->pixels_ - pixel;
+      if (this->run_count_ > kRunPixels) {
+        this->run_count_ = kRunPixels;
+      }
+      // past the end of the strip nothing is read back, and nothing is set
+      this->controller_->GetFrame(pixel, this->run_, this->run_count_);
+    }
+
+    const uint32_t offset = pos - this->run_first_ * sizeof(Pixel);
+    uint32_t take = this->run_count_ * sizeof(Pixel) - offset;
+    if (take > len) {
+      take = len;
+    }
+    uint8_t *out = reinterpret_cast<uint8_t *>(this->run_) + offset;
+    for (uint32_t i = 0; i < take; ++i) {
+      out[i] ^= in[i];
+    }
+    pos += take;
+    in += take;
+    len -= take;
+  }
+}
+
+void PlaybackPreset::FlushRun() {
+  if (this->run_count_ == 0) {
+    return;
+  }
+  this->controller_->Blit(this->run_first_, this->run_, this->run_count_);
+  this->run_count_ = 0;
+  this->changed_ = true;
+}
+
+size_t PlaybackPreset::Read(uint8_t *out, size_t len) {
+  size_t done = 0;
+  while (done < len) {
+    if (this->chunk_pos_ == this->chunk_len_ && !this->Refill()) {
+      break;
+    }
+    size_t take = this->chunk_len_ - this->chunk_pos_;
+    if (take > len - done) {
+      take = len - done;
+    }
+    memcpy(out + done, this->chunk_ + this->chunk_pos_, take);
+    this->chunk_pos_ += take;
+    done += take;
+  }
+  return done;
+}
+
+bool PlaybackPreset::Refill() {
+  this->chunk_pos_ = 0;
+  this->chunk_len_ =
+      static_cast<uint8_t>(this->source_->Read(this->chunk_, kChunk));
+  return this->chunk_len_ > 0;
+}
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
@@ -0,0 +1,210 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_PRESET_PLAYBACK_H
+#define LIGHTSHOW_PRESET_PLAYBACK_H
+
+#include "LightShow.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <memory>
+
+#include "FrameSource.h"
+#include "Pixel.h"
+#include "Preset.h"
+
+namespace LightShow {
+
+/**
+ * play a recorded show, frame by frame
+ *
+ * Frames are decoded as they are streamed from the source, so the show does
+ * not need to fit in RAM.  The preset holds no frame of its own: each frame
+ * is applied straight to the controller's frame, a short run of pixels at a
+ * time, and only the runs that a frame changes are read back and set.  As
+ * each frame is decoded over the controller's frame, nothing else should
+ * draw to the controller while the show plays; if something does, the show
+ * is wrong until its next keyframe.
+ */
+class PlaybackPreset : public Preset {
+ public:
+  /**
+   * Create a preset that plays a recorded show
+   * @param controller the controller used to set LEDs
+   * @param source where to read the show from, which must outlive the preset
+   */
+  PlaybackPreset(std::shared_ptr<Controller> controller, FrameSource *source);
+
+  /**
+   * Start the show from the first frame
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Start() override;
+
+  /**
+   * Show the frame that is due, if it has changed
+   * Frames that were due while loop() was busy are decoded, but only the
+   * latest is pushed.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Loop() override;
+
+  /**
+   * Set whether the show starts over when it ends
+   * @param repeat true to start over, false to hold the last frame
+   */
+  void SetRepeat(bool repeat);
+
+  /**
+   * return the number of pixels in each frame of the show
+   * @return the number of pixels, or 0 before Start()
+   */
+  uint32_t GetPixelCount() const;
+
+  /**
+   * return how many frames have been decoded
+   * @return the number of frames decoded
+   */
+  uint32_t GetDecodedFrames() const;
+
+  /**
+   * return how many encoded bytes have been decoded
+   * @return the number of bytes read from the source
+   */
+  uint32_t GetDecodedBytes() const;
+
+  /**
+   * return how long has been spent decoding
+   * @return the time in microseconds
+   */
+  uint32_t GetDecodeTime() const;
+
+ protected:
+  /// the number of bytes read from the source at a time
+  static constexpr uint8_t kChunk = 64;
+
+  /// the number of pixels read back from the controller at a time
+  static constexpr uint8_t kRunPixels = 16;
+
+  /**
+   * Read the file header
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error ReadHeader();
+
+  /**
+   * Decode the next frame over the controller's frame
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error DecodeFrame();
+
+  /**
+   * XOR bytes into the controller's frame, through the run of pixels
+   * @param pos the offset within the frame of the first byte to change
+   * @param in the bytes to XOR, len long
+   * @param len the number of bytes to change
+   */
+  void Xor(uint32_t pos, const uint8_t *in, uint32_t len);
+
+  /**
+   * Set the run of pixels back on the controller, if it holds any
+   */
+  void FlushRun();
+
+  /**
+   * Read bytes through the chunk buffer
+   * @param out where to store the bytes
+   * @param len the number of bytes to read
+   * @return the number of bytes read, which is less than len at the end
+   */
+  size_t Read(uint8_t *out, size_t len);
+
+  /**
+   * Replace the chunk buffer with the next bytes from the source
+   * @return true if any bytes were read, else false
+   */
+  bool Refill();
+
+  /// controller that will be used to set LEDs
+  std::shared_ptr<Controller> controller_;
+
+  /// where the show is read from
+  FrameSource *source_;
+
+  /// the number of pixels in each frame of the show
+  uint32_t pixels_ = 0;
+
+  /// the pixels being changed, read back from the controller
+  Pixel run_[kRunPixels];
+
+  /// the index of the first pixel in run_
+  uint32_t run_first_ = 0;
+
+  /// the number of pixels in run_, or 0 if it holds none
+  uint32_t run_count_ = 0;
+
+  /// bytes read from the source but not yet decoded
+  uint8_t chunk_[kChunk];
+
+  /// the offset of the next byte to decode in chunk_
+  uint8_t chunk_pos_ = 0;
+
+  /// the number of bytes in chunk_
+  uint8_t chunk_len_ = 0;
+
+  /// the number of frames in the show
+  uint32_t frame_count_ = 0;
+
+  /// the time between frames
+  uint16_t frame_ms_ = 0;
+
+  /// the index of the next frame to decode
+  uint32_t next_frame_ = 0;
+
+  /// the millis() time at which the show started
+  uint32_t start_ms_ = 0;
+
+  /// true if the show starts over when it ends
+  bool repeat_ = true;
+
+  /// true if the controller's frame has changed since the last push
+  bool changed_ = false;
+
+  /// the number of frames decoded
+  uint32_t decoded_frames_ = 0;
+
+  /// the number of bytes decoded
+  uint32_t decoded_bytes_ = 0;
+
+  /// the time spent decoding
+  uint32_t decode_us_ = 0;
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
+
+#endif  // LIGHTSHOW_PRESET_PLAYBACK_H
@@ -31,6 +31,8 @@
 
 namespace LightShow {
 
+class Controller;
+
 /**
  * a base LightShow current_preset that includes no instructions
  */
@@ -53,6 +55,24 @@ class Preset {
    * @return 0 on success or a LightShow::Error on error
    */
   virtual Error Loop() { return NoError; }
+
+  /**
+   * Let a Scheduler push frames on behalf of this preset
+   * @param scheduled true if the scheduler calls Update() once per frame,
+   * false if the preset calls it itself whenever its output changes
+   */
+  void SetScheduled(bool scheduled) { this->scheduled_ = scheduled; }
+
+ protected:
+  /**
+   * Push the LEDs that this preset has set, unless a Scheduler does so
+   * @param controller the controller to push
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error PushFrame(Controller *controller);
+
+  /// true if a Scheduler pushes frames for this preset
+  bool scheduled_ = false;
 };
 
 }  // namespace LightShow
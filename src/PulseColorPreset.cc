@@ -25,57 +25,8 @@
 
 #include "PulseColorPreset.h"
 
-#include <utility>
-
 namespace LightShow {
 
-PulseColorPreset::PulseColorPreset(std::shared_ptr<Controller> controller,
-                                   uint8_t r, uint8_t g, uint8_t b,
-                                   uint32_t interval, uint32_t steps)
-    : controller_(std::move(controller)),
-      r_(r),
-      g_(g),
-      b_(b),
-      interval_(interval),
-      steps_(steps) {}
-
-Error PulseColorPreset::Loop() {
-  // skip this cycle if it's not time to color change yet
-  if (++this->loop_count_ < this->interval_) {
-    return NoError;
-  }
-
-  // it's time to color change, reset the counter
-  this->loop_count_ = 0;
-
-  // switch directions if needed
-  if (this->steps_taken_ >= this->steps_) {
-    this->advancing_ = false;
-  } else if (this->steps_taken_ == 0) {
-    this->advancing_ = true;
-  }
-
-  // update LEDs
-  this->controller_->SetLEDs(
-      static_cast<uint8_t>((static_cast<float>(this->steps_taken_) /
-                            static_cast<float>(this->steps_)) *
-                           static_cast<float>(this->r_)),
-      static_cast<uint8_t>((static_cast<float>(this->steps_taken_) /
-                            static_cast<float>(this->steps_)) *
-                           static_cast<float>(this->g_)),
-      static_cast<uint8_t>((static_cast<float>(this->steps_taken_) /
-                            static_cast<float>(this->steps_)) *
-                           static_cast<float>(this->b_)));
-  this->controller_->Update();
-
-  // take another step
-  if (this->advancing_) {
-    this->steps_taken_++;
-  } else {
-    this->steps_taken_--;
-  }
-
-  return NoError;
-}
+template class BasicPulseColorPreset<Controller>;
 
 }  // namespace LightShow
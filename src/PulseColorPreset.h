@@ -26,40 +26,106 @@
 #ifndef LIGHTSHOW_PRESET_PULSECOLOR_H
 #define LIGHTSHOW_PRESET_PULSECOLOR_H
 
-#include <memory>
-
+#include "Curve.h"
+#include "LightShow.h"
 #include "Preset.h"
 
+#if LIGHTSHOW_NO_HEAP != 1
+#include <memory>
+#include <utility>
+#endif
+
 namespace LightShow {
 
 /**
  * fade a color in and out
+ *
+ * Use the PulseColorPreset typedef to drive any Controller through its virtual
+ * interface.  When the type of the controller is known at compile time, name
+ * it as ControllerT instead, so that its methods are called directly and can
+ * be inlined into Loop().
+ * @tparam ControllerT the type of the controller used to set LEDs
  */
-class PulseColorPreset : public Preset {
+template <class ControllerT>
+class BasicPulseColorPreset : public Preset {
  public:
   /**
-   * Create a current_preset that flashes a color
+   * Create a preset for a controller that outlives it, such as a global
    * @param controller the controller used to set LEDs
    * @param r red 0-255
    * @param g green 0-255
    * @param b blue 0-255
    * @param interval the number of loop cycles between incremental color change
-   * @param steps the number of steps_ to take between the target value
+   * @param steps the number of steps_ to take between the target value, at
+   * least 1, so 0 is taken as 1
+   */
+  explicit BasicPulseColorPreset(ControllerT &controller,  // NOLINT
+                                 uint8_t r = 0xFF, uint8_t g = 0xFF,
+                                 uint8_t b = 0xFF, uint32_t interval = 1,
+                                 uint32_t steps = 100);
+
+#if LIGHTSHOW_NO_HEAP != 1
+  /**
+   * Create a current_preset that flashes a color
+   * @param controller the controller used to set LEDs, which the preset keeps
+   * alive
+   * @param r red 0-255
+   * @param g green 0-255
+   * @param b blue 0-255
+   * @param interval the number of loop cycles between incremental color change
+   * @param steps the number of steps_ to take between the target value, at
+   * least 1, so 0 is taken as 1
    */
-  explicit PulseColorPreset(std::shared_ptr<Controller> controller,
-                            uint8_t r = 0xFF, uint8_t g = 0xFF,
-                            uint8_t b = 0xFF, uint32_t interval = 1,
-                            uint32_t steps = 100);
+  explicit BasicPulseColorPreset(std::shared_ptr<ControllerT> controller,
+                                 uint8_t r = 0xFF, uint8_t g = 0xFF,
+                                 uint8_t b = 0xFF, uint32_t interval = 1,
+                                 uint32_t steps = 100)
+      : BasicPulseColorPreset(*controller, r, g, b, interval, steps) {
+    this->owner_ = std::move(controller);
+  }
+#endif
+
+  /**
+   * Start this preset
+   * In time-based mode, the pulse starts from 0 at this point.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Start() override;
 
   /**
    * Perform one loop
+   * LEDs are only set and pushed when the color changes, or when something
+   * else has written to the controller since the last push.
    * @return 0 on success or a LightShow::Error on error
    */
   Error Loop() override;
 
+  /**
+   * Advance the pulse by wall-clock time instead of by loop count
+   * The brightness is computed from the time elapsed since Start(), so the
+   * speed of the pulse does not depend on how fast loop() runs.  interval is
+   * ignored in this mode.
+   * @param period_ms the time taken to fade up and back down, in milliseconds,
+   * or 0 to advance one step every interval loop cycles
+   */
+  void SetPeriod(uint32_t period_ms);
+
+  /**
+   * Set the shape of the brightness ramp
+   * The ramp is looked up in a table generated at compile time, so changing
+   * the curve costs nothing per loop.
+   * @param curve the curve to follow between 0 and the target color
+   */
+  void SetCurve(Curve curve);
+
  protected:
   /// controller that will be used to set LEDs
-  std::shared_ptr<Controller> controller_;
+  ControllerT *controller_;
+
+#if LIGHTSHOW_NO_HEAP != 1
+  /// keeps controller_ alive, if the preset was given shared ownership of it
+  std::shared_ptr<ControllerT> owner_;
+#endif
 
   /// red byte of the color to cycle
   uint8_t r_;
@@ -84,8 +150,144 @@ class PulseColorPreset : public Preset {
 
   /// how many steps have been taken this cycle
   uint32_t steps_taken_ = 0;
+
+  /// the table of brightness values for the selected curve, in program memory
+  const uint8_t *curve_;
+
+  /// converts steps taken to an index into curve_, in 16.16 fixed point
+  uint32_t curve_scale_;
+
+  /// the time taken to fade up and back down, or 0 to advance by loop count
+  uint32_t period_ms_ = 0;
+
+  /// the millis() time at which the preset was started
+  uint32_t start_ms_ = 0;
+
+  /// true if last_ holds the color most recently pushed
+  bool pushed_ = false;
+
+  /// the color most recently pushed
+  uint8_t last_[3];
+
+  /// the controller's frame version once last_ was set, so that a frame
+  /// drawn over by a fade, a show or another preset is pushed again
+  uint32_t version_ = 0;
+
+  /**
+   * Set and push the LEDs, unless they still show this color
+   * @param r red 0-255
+   * @param g green 0-255
+   * @param b blue 0-255
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Push(uint8_t r, uint8_t g, uint8_t b);
 };
 
+/// a pulse that drives any Controller through its virtual interface
+typedef BasicPulseColorPreset<Controller> PulseColorPreset;
+
+// the virtual version is compiled once, in PulseColorPreset.cc
+extern template class BasicPulseColorPreset<Controller>;
+
+template <class ControllerT>
+BasicPulseColorPreset<ControllerT>::BasicPulseColorPreset(
+    ControllerT &controller, uint8_t r, uint8_t g, uint8_t b, uint32_t interval,
+    uint32_t steps)
+    : controller_(&controller),
+      r_(r),
+      g_(g),
+      b_(b),
+      interval_(interval),
+      // with no steps to take, stepping back down from 0 would wrap around
+      steps_((steps > 0) ? steps : 1),
+      curve_(GetCurveTable(Curve::Linear)) {
+  // round up, so that the last step lands on the last entry of the table
+  this->curve_scale_ = ((255UL << 16) + this->steps_ - 1) / this->steps_;
+}
+
+template <class ControllerT>
+Error BasicPulseColorPreset<ControllerT>::Start() {
+  this->start_ms_ = millis();
+  this->pushed_ = false;
+  return NoError;
+}
+
+template <class ControllerT>
+void BasicPulseColorPreset<ControllerT>::SetPeriod(uint32_t period_ms) {
+  this->period_ms_ = period_ms;
+}
+
+template <class ControllerT>
+void BasicPulseColorPreset<ControllerT>::SetCurve(Curve curve) {
+  this->curve_ = GetCurveTable(curve);
+}
+
+template <class ControllerT>
+Error BasicPulseColorPreset<ControllerT>::Loop() {
+  this->controller_->BeginRender();
+  if (this->period_ms_ != 0) {
+    // find how far through the current cycle we are, and convert that to the
+    // number of steps taken up (or back down) the ramp
+    const uint32_t phase = (millis() - this->start_ms_) % this->period_ms_;
+    const uint32_t half = (this->period_ms_ > 1) ? this->period_ms_ / 2 : 1;
+    const uint32_t offset = (phase < half) ? phase : this->period_ms_ - phase;
+    const uint64_t steps = static_cast<uint64_t>(offset) * this->steps_ / half;
+    this->steps_taken_ =
+        (steps < this->steps_) ? static_cast<uint32_t>(steps) : this->steps_;
+  } else {
+    // skip this cycle if it's not time to color change yet
+    if (++this->loop_count_ < this->interval_) {
+      return NoError;
+    }
+
+    // it's time to color change, reset the counter
+    this->loop_count_ = 0;
+
+    // switch directions if needed
+    if (this->steps_taken_ >= this->steps_) {
+      this->advancing_ = false;
+    } else if (this->steps_taken_ == 0) {
+      this->advancing_ = true;
+    }
+  }
+
+  // look up the brightness for this step and scale the color by it
+  const uint32_t index = (this->steps_taken_ * this->curve_scale_) >> 16;
+  const uint8_t level =
+      pgm_read_byte(this->curve_ + ((index < 255) ? index : 255));
+  const auto e = this->Push(Scale8(this->r_, level), Scale8(this->g_, level),
+                            Scale8(this->b_, level));
+
+  // take another step
+  if (this->period_ms_ == 0) {
+    if (this->advancing_) {
+      this->steps_taken_++;
+    } else {
+      this->steps_taken_--;
+    }
+  }
+
+  return e;
+}
+
+template <class ControllerT>
+Error BasicPulseColorPreset<ControllerT>::Push(uint8_t r, uint8_t g,
+                                               uint8_t b) {
+  if (this->pushed_ && this->last_[0] == r && this->last_[1] == g &&
+      this->last_[2] == b &&
+      this->controller_->GetFrameVersion() == this->version_) {
+    return NoError;
+  }
+  this->last_[0] = r;
+  this->last_[1] = g;
+  this->last_[2] = b;
+  this->pushed_ = true;
+
+  this->controller_->SetLEDs(r, g, b);
+  this->version_ = this->controller_->GetFrameVersion();
+  return this->PushFrame(this->controller_);
+}
+
 }  // namespace LightShow
 
 #endif  // LIGHTSHOW_PRESET_PULSECOLOR_H
@@ -0,0 +1,119 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "Scheduler.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <utility>
+
+namespace LightShow {
+
+Scheduler::Scheduler(std::shared_ptr<Controller> controller, uint32_t fps)
+    : controller_(std::move(controller)) {
+  this->SetFrameRate(fps);
+}
+
+int Scheduler::AddPreset(std::shared_ptr<Preset> preset) {
+  preset->SetScheduled(true);
+  this->presets_.push_back(std::move(preset));
+  return static_cast<int>(this->presets_.size()) - 1;
+}
+
+int Scheduler::GetPresetCount() const {
+  return static_cast<int>(this->presets_.size());
+}
+
+Error Scheduler::Start(int preset) {
+  if (preset < 0 || preset >= this->GetPresetCount()) {
+    return ShowIndexOutOfRange;
+  }
+  this->active_ = preset;
+  return this->presets_[preset]->Start();
+}
+
+Error Scheduler::Stop() {
+  this->active_ = -1;
+  return this->controller_->Stop();
+}
+
+Error Scheduler::Loop() {
+  const uint32_t now = micros();
+  if (!this->running_) {
+    this->next_frame_us_ = now;
+    this->running_ = true;
+  }
+
+  // the next frame is not due yet
+  const uint32_t late_us = now - this->next_frame_us_;
+  if (late_us >= 0x80000000UL) {
+    return NoError;
+  }
+
+  // drop any frames whose slot has already passed, keeping the deadlines on
+  // the original grid
+  const uint32_t behind = late_us / this->period_us_;
+  this->skipped_frames_ += behind;
+  this->next_frame_us_ += (behind + 1) * this->period_us_;
+
+  // render the preset, fade and show step, then push the result once
+  this->controller_->BeginFrame();
+  Error e = NoError;
+  if (this->active_ >= 0) {
+    e = this->presets_[this->active_]->Loop();
+  }
+  if (e == NoError) {
+    e = this->controller_->Loop();
+  }
+  const Error pushed = this->controller_->EndFrame();
+  if (e == NoError) {
+    e = pushed;
+  }
+  this->frames_++;
+
+  // the frame ran into the next one's slot
+  if (micros() - this->next_frame_us_ < 0x80000000UL) {
+    this->late_frames_++;
+  }
+  return e;
+}
+
+void Scheduler::SetFrameRate(uint32_t fps) {
+  this->period_us_ = 1000000UL / ((fps > 0) ? fps : 1);
+}
+
+int Scheduler::GetActivePreset() const { return this->active_; }
+
+uint32_t Scheduler::GetFrameCount() const { return this->frames_; }
+
+uint32_t Scheduler::GetLateFrameCount() const { return this->late_frames_; }
+
+uint32_t Scheduler::GetSkippedFrameCount() const {
+  return this->skipped_frames_;
+}
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
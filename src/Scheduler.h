@@ -0,0 +1,164 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_SCHEDULER_H
+#define LIGHTSHOW_SCHEDULER_H
+
+#include "LightShow.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <memory>
+#include <vector>
+
+#include "Controller.h"
+#include "Preset.h"
+
+namespace LightShow {
+
+/**
+ * drives a preset at a fixed frame rate
+ *
+ * Presets are registered once, then started by index.  Each call to Loop()
+ * checks micros() against the next frame deadline.  When a frame is due, the
+ * active preset is looped and the controller is updated at most once, and not
+ * at all if nothing changed the frame.  Start fades with BeginFade(), as a
+ * blocking Fade() called from a scheduled preset is never seen.
+ * Deadlines advance by a whole frame period from the previous deadline, not
+ * from the time the frame ran, so timing errors do not accumulate.  When the
+ * sketch falls a whole frame or more behind, the missed frames are skipped and
+ * counted rather than rendered in a burst.
+ */
+class Scheduler {
+ public:
+  /**
+   * Create a scheduler
+   * @param controller the controller that the presets draw to
+   * @param fps the number of frames to render each second
+   */
+  explicit Scheduler(std::shared_ptr<Controller> controller, uint32_t fps = 60);
+
+  /**
+   * Register a preset, so that it can be started by index
+   * The preset no longer pushes its own frames; the scheduler does.
+   * @param preset the preset to register
+   * @return the index of the preset
+   */
+  int AddPreset(std::shared_ptr<Preset> preset);
+
+  /**
+   * return how many presets are registered
+   * If this is 0, then no shows can be started.
+   * @return the number of registered presets
+   */
+  int GetPresetCount() const;
+
+  /**
+   * Start a registered preset, replacing the active one
+   * @param preset the index of the preset to start (0-indexed)
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Start(int preset);
+
+  /**
+   * Stop the active preset and turn the LEDs off
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Stop();
+
+  /**
+   * Render a frame if one is due
+   * Call this once from each pass through the sketch's loop().  A fade or
+   * show program started on the controller is advanced along with the
+   * preset, and the frame they draw is pushed once, whether or not any of
+   * them asked for a push.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Loop();
+
+  /**
+   * Change the frame rate
+   * @param fps the number of frames to render each second
+   */
+  void SetFrameRate(uint32_t fps);
+
+  /**
+   * return the index of the active preset
+   * @return the index of the active preset, or -1 if none is active
+   */
+  int GetActivePreset() const;
+
+  /**
+   * return how many frames have been rendered
+   * @return the number of frames rendered
+   */
+  uint32_t GetFrameCount() const;
+
+  /**
+   * return how many frames finished after the next frame was due
+   * @return the number of frames that overran their deadline
+   */
+  uint32_t GetLateFrameCount() const;
+
+  /**
+   * return how many frames were skipped because the sketch fell behind
+   * @return the number of frames skipped
+   */
+  uint32_t GetSkippedFrameCount() const;
+
+ protected:
+  /// the controller that the presets draw to
+  std::shared_ptr<Controller> controller_;
+
+  /// every registered preset
+  std::vector<std::shared_ptr<Preset>> presets_;
+
+  /// the index of the active preset, or -1 if none is active
+  int active_ = -1;
+
+  /// the time between frames, in microseconds
+  uint32_t period_us_;
+
+  /// the micros() time at which the next frame is due
+  uint32_t next_frame_us_ = 0;
+
+  /// true once next_frame_us_ has been set by the first call to Loop()
+  bool running_ = false;
+
+  /// the number of frames rendered
+  uint32_t frames_ = 0;
+
+  /// the number of frames that overran their deadline
+  uint32_t late_frames_ = 0;
+
+  /// the number of frames skipped
+  uint32_t skipped_frames_ = 0;
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
+
+#endif  // LIGHTSHOW_SCHEDULER_H
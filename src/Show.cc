@@ -0,0 +1,186 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "Show.h"
+
+#include "Controller.h"
+#include "Preset.h"
+
+namespace LightShow {
+
+uint8_t GetShowOpLength(uint8_t op) {
+  switch (op) {
+    case kShowEnd:
+      return 1;
+    case kShowSet:
+      return 4;
+    case kShowFade:
+      return 6;
+    case kShowHold:
+      return 3;
+    case kShowLoop:
+      return 4;
+    case kShowCall:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+void ShowPlayer::Play(const uint8_t *program) {
+  this->program_ = program;
+  this->pc_ = 0;
+  this->wait_ = Wait::None;
+  this->loop_depth_ = 0;
+}
+
+void ShowPlayer::Stop() { this->program_ = nullptr; }
+
+bool ShowPlayer::IsPlaying() const { return this->program_ != nullptr; }
+
+void ShowPlayer::SetPresets(Preset *const *presets, uint8_t count) {
+  this->presets_ = presets;
+  this->preset_count_ = count;
+}
+
+uint16_t ShowPlayer::ReadWord(uint16_t offset) const {
+  return static_cast<uint16_t>(
+      pgm_read_byte(this->program_ + offset) |
+      (pgm_read_byte(this->program_ + offset + 1) << 8));
+}
+
+Error ShowPlayer::Step(Controller *controller) {
+  if (this->program_ == nullptr) {
+    return NoError;
+  }
+
+  // carry on waiting for the running instruction, if it is not done yet
+  switch (this->wait_) {
+    case Wait::Fade:
+      if (controller->IsFading()) {
+        return NoError;
+      }
+      break;
+    case Wait::Time:
+      if (millis() - this->deadline_ >= 0x80000000UL) {
+        return NoError;
+      }
+      break;
+    case Wait::Preset:
+      if (millis() - this->deadline_ >= 0x80000000UL) {
+        return this->preset_->Loop();
+      }
+      break;
+    case Wait::None:
+    default:
+      break;
+  }
+  this->wait_ = Wait::None;
+
+  const uint8_t *p = this->program_;
+  for (uint8_t n = 0; n < kWindow; n++) {
+    const uint16_t pc = this->pc_;
+    const uint8_t op = pgm_read_byte(p + pc);
+    this->pc_ += GetShowOpLength(op);
+
+    switch (op) {
+      case kShowEnd:
+        this->program_ = nullptr;
+        return NoError;
+
+      case kShowSet: {
+        auto e = controller->SetLEDs(pgm_read_byte(p + pc + 1),
+                                     pgm_read_byte(p + pc + 2),
+                                     pgm_read_byte(p + pc + 3));
+        if (e == NoError) {
+          e = controller->Update();
+        }
+        if (e != NoError) {
+          return e;
+        }
+        break;
+      }
+
+      case kShowFade:
+        this->wait_ = Wait::Fade;
+        return controller->BeginFade(this->ReadWord(pc + 4),
+                                     pgm_read_byte(p + pc + 1),
+                                     pgm_read_byte(p + pc + 2),
+                                     pgm_read_byte(p + pc + 3));
+
+      case kShowHold:
+        this->wait_ = Wait::Time;
+        this->deadline_ = millis() + this->ReadWord(pc + 1);
+        return NoError;
+
+      case kShowLoop: {
+        const uint16_t target = this->ReadWord(pc + 1);
+        const uint8_t count = pgm_read_byte(p + pc + 3);
+        uint8_t &depth = this->loop_depth_;
+        if (count == 0) {
+          // repeat forever
+          this->pc_ = target;
+        } else if (depth > 0 && this->loop_pc_[depth - 1] == pc) {
+          // this loop is already running, so count down one more pass
+          if (--this->loop_left_[depth - 1] == 0) {
+            depth--;
+          } else {
+            this->pc_ = target;
+          }
+        } else if (count > 1) {
+          // the first pass has run; start counting the rest
+          if (depth >= kMaxLoopDepth) {
+            this->program_ = nullptr;
+            return ShowUndefined;
+          }
+          this->loop_pc_[depth] = pc;
+          this->loop_left_[depth] = count - 1;
+          depth++;
+          this->pc_ = target;
+        }
+        break;
+      }
+
+      case kShowCall: {
+        const uint8_t index = pgm_read_byte(p + pc + 1);
+        if (index >= this->preset_count_) {
+          this->program_ = nullptr;
+          return ShowIndexOutOfRange;
+        }
+        this->preset_ = this->presets_[index];
+        this->wait_ = Wait::Preset;
+        this->deadline_ = millis() + this->ReadWord(pc + 2);
+        return this->preset_->Start();
+      }
+
+      default:
+        this->program_ = nullptr;
+        return ShowUndefined;
+    }
+  }
+  return NoError;
+}
+
+}  // namespace LightShow
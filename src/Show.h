@@ -0,0 +1,159 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_SHOW_H
+#define LIGHTSHOW_SHOW_H
+
+#include <Arduino.h>
+
+#include "Error.h"
+#include "LightShow.h"
+
+namespace LightShow {
+
+class Controller;
+class Preset;
+
+/**
+ * the instructions of a show program
+ *
+ * A program is a run of bytes, normally in program memory.  Each instruction
+ * is an opcode followed by its operands.  Durations and offsets are 16-bit
+ * little-endian values; durations are in milliseconds.
+ */
+enum ShowOp : uint8_t {
+  /// stop the show
+  kShowEnd = 0x00,
+  /// set every LED and push: r, g, b
+  kShowSet = 0x01,
+  /// fade every LED to a color: r, g, b, duration
+  kShowFade = 0x02,
+  /// leave the LEDs as they are: duration
+  kShowHold = 0x03,
+  /// repeat from an offset until run count times (0 is forever): offset, count
+  kShowLoop = 0x04,
+  /// run a preset from the controller's preset table: index, duration
+  kShowCall = 0x05
+};
+
+/**
+ * return the length of an instruction
+ * @param op the opcode of the instruction
+ * @return the number of bytes in the instruction, including the opcode, or 0
+ * if the opcode is not known
+ */
+uint8_t GetShowOpLength(uint8_t op);
+
+/**
+ * a non-blocking interpreter for show programs
+ *
+ * Each call to Step() runs instructions until one of them has to wait, or
+ * until a small window of instructions has run, so a program never stalls the
+ * sketch's loop().  Controllers embed a player, and advance it from Loop().
+ */
+class ShowPlayer {
+ public:
+  /// the most instructions run by one call to Step()
+  static constexpr uint8_t kWindow = 8;
+
+  /// the deepest that kShowLoop instructions can be nested
+  static constexpr uint8_t kMaxLoopDepth = 4;
+
+  /**
+   * Start a program from the beginning
+   * @param program the program, in program memory
+   */
+  void Play(const uint8_t *program);
+
+  /**
+   * Stop the running program
+   */
+  void Stop();
+
+  /**
+   * check whether a program is running
+   * @return true if a program is running, else false
+   */
+  bool IsPlaying() const;
+
+  /**
+   * Set the presets that kShowCall instructions can run
+   * @param presets the presets, indexed by the kShowCall operand
+   * @param count the number of presets
+   */
+  void SetPresets(Preset *const *presets, uint8_t count);
+
+  /**
+   * Run instructions until one of them has to wait
+   * @param controller the controller that the program drives
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Step(Controller *controller);
+
+ protected:
+  /// what the running instruction is waiting for
+  enum class Wait : uint8_t { None, Fade, Time, Preset };
+
+  /**
+   * read a 16-bit operand
+   * @param offset the offset of the operand within the program
+   * @return the value of the operand
+   */
+  uint16_t ReadWord(uint16_t offset) const;
+
+  /// the running program, in program memory, or nullptr
+  const uint8_t *program_ = nullptr;
+
+  /// the offset of the next instruction
+  uint16_t pc_ = 0;
+
+  /// what the running instruction is waiting for
+  Wait wait_ = Wait::None;
+
+  /// the millis() time at which a hold or preset call ends
+  uint32_t deadline_ = 0;
+
+  /// the preset run by the current kShowCall instruction
+  Preset *preset_ = nullptr;
+
+  /// the presets that kShowCall instructions can run
+  Preset *const *presets_ = nullptr;
+
+  /// the number of presets in presets_
+  uint8_t preset_count_ = 0;
+
+  /// the offsets of the kShowLoop instructions being repeated
+  uint16_t loop_pc_[kMaxLoopDepth];
+
+  /// the number of repeats left for each loop in loop_pc_
+  uint8_t loop_left_[kMaxLoopDepth];
+
+  /// the number of loops being repeated
+  uint8_t loop_depth_ = 0;
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_SHOW_H
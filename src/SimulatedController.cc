@@ -0,0 +1,173 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "SimulatedController.h"
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+
+#include <algorithm>
+#include <utility>
+
+namespace LightShow {
+
+SimulatedController::SimulatedController(uint32_t num, VirtualClock *clock,
+                                         uint32_t update_us)
+    : pixels_(num), fade_from_(num), clock_(clock), update_us_(update_us) {
+  this->CountAllocations(2);
+  this->TrackPower(num);
+}
+
+Error SimulatedController::BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g,
+                                     uint8_t b) {
+  std::copy(this->pixels_.begin(), this->pixels_.end(),
+            this->fade_from_.begin());
+  this->fade_to_.r = r;
+  this->fade_to_.g = g;
+  this->fade_to_.b = b;
+  this->StartFade(fade_ms,
+                  static_cast<uint32_t>(this->pixels_.size()) * (r + g + b));
+  return NoError;
+}
+
+Error SimulatedController::BeginCrossFade(uint32_t fade_ms,
+                                          const Pixel *target,
+                                          uint32_t count) {
+  const uint32_t size = static_cast<uint32_t>(this->pixels_.size());
+  if (this->fade_target_.empty()) {
+    this->fade_target_.resize(size);
+    this->CountAllocations(1);
+  }
+  return this->StartCrossFade(fade_ms, this->pixels_.data(),
+                              this->fade_from_.data(),
+                              this->fade_target_.data(), size, target, count);
+}
+
+Error SimulatedController::RenderFade(uint16_t weight) {
+  uint8_t *frame = reinterpret_cast<uint8_t *>(this->pixels_.data());
+  const uint8_t *from =
+      reinterpret_cast<const uint8_t *>(this->fade_from_.data());
+  const size_t len = this->pixels_.size() * sizeof(Pixel);
+  if (this->IsCrossFade()) {
+    LerpBuffer(frame, from,
+               reinterpret_cast<const uint8_t *>(this->fade_target_.data()),
+               len, weight);
+  } else {
+    LerpToColor(frame, from, len,
+                reinterpret_cast<const uint8_t *>(&this->fade_to_),
+                sizeof(Pixel), weight);
+  }
+  return this->Update();
+}
+
+Error SimulatedController::EndFade() { return this->RenderFade(kLerpOne); }
+
+Error SimulatedController::SetLEDs(uint8_t r, uint8_t g, uint8_t b) {
+  for (auto &item : this->pixels_) {
+    item.r = r;
+    item.g = g;
+    item.b = b;
+  }
+  this->TrackFrame(static_cast<uint32_t>(this->pixels_.size()) * (r + g + b));
+  return NoError;
+}
+
+Error SimulatedController::SetLED(uint32_t i, uint8_t r, uint8_t g,
+                                  uint8_t b) {
+  if (i >= this->pixels_.size()) {
+    return LEDIndexOutOfRange;
+  }
+  const Pixel &old = this->pixels_[i];
+  this->TrackPixel(old.r + old.g + old.b, r + g + b);
+  this->pixels_[i].r = r;
+  this->pixels_[i].g = g;
+  this->pixels_[i].b = b;
+  return NoError;
+}
+
+Error SimulatedController::SetRange(uint32_t first, uint32_t count, uint8_t r,
+                                    uint8_t g, uint8_t b) {
+  return this->FillRange(this->pixels_.data(), this->pixels_.size(), first,
+                         count, Pixel{r, g, b});
+}
+
+Error SimulatedController::Blit(uint32_t first, const Pixel *src,
+                                uint32_t count) {
+  return this->BlitRange(this->pixels_.data(), this->pixels_.size(), first, src,
+                         count);
+}
+
+Error SimulatedController::GetFrame(uint32_t first, Pixel *dst,
+                                    uint32_t count) const {
+  return ReadRange(this->pixels_.data(), this->pixels_.size(), first, dst,
+                   count);
+}
+
+Error SimulatedController::Transmit() {
+  this->frame_count_++;
+  if (this->capture_) {
+    SimulatedFrame frame;
+    frame.time_us = micros();
+    frame.pixels = this->pixels_;
+    const OutputStage *stage = this->GetOutputStage();
+    if (stage != nullptr) {
+      stage->Apply(frame.pixels.data(), frame.pixels.data(),
+                   frame.pixels.size());
+    }
+    if (this->GetPowerScale() != 0xFF) {
+      auto *bytes = reinterpret_cast<uint8_t *>(frame.pixels.data());
+      ScaleBuffer(bytes, bytes, frame.pixels.size() * sizeof(Pixel),
+                  this->GetPowerScale());
+    }
+    this->frames_.push_back(std::move(frame));
+  }
+
+  // pushing a frame takes time on a real strip
+  if (this->clock_ != nullptr) {
+    this->clock_->Advance(this->update_us_);
+  }
+  return NoError;
+}
+
+const std::vector<Pixel> &SimulatedController::GetPixels() const {
+  return this->pixels_;
+}
+
+const std::vector<SimulatedFrame> &SimulatedController::GetFrames() const {
+  return this->frames_;
+}
+
+void SimulatedController::ClearFrames() { this->frames_.clear(); }
+
+void SimulatedController::SetCapture(bool capture) {
+  this->capture_ = capture;
+}
+
+uint32_t SimulatedController::GetFrameCount() const {
+  return this->frame_count_;
+}
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_SIMULATED_ENABLE
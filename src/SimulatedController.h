@@ -0,0 +1,224 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_SIMULATEDCONTROLLER_H
+#define LIGHTSHOW_SIMULATEDCONTROLLER_H
+
+#include "Controller.h"
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+
+#include <vector>
+
+#include "Pixel.h"
+#include "VirtualClock.h"
+
+namespace LightShow {
+
+/**
+ * a frame pushed to a SimulatedController
+ */
+struct SimulatedFrame {
+  /// the micros() time at which the frame was pushed
+  uint32_t time_us;
+
+  /// the value of every pixel in the frame, after any output stage
+  std::vector<Pixel> pixels;
+};
+
+/**
+ * a controller with no hardware behind it, for running shows on a host
+ *
+ * Every frame passed to Update() is captured in memory along with its
+ * timestamp.  Paired with a VirtualClock, presets and fades run faster than
+ * real time and produce the same frames on every run.
+ */
+class SimulatedController final : public Controller {
+ public:
+  /**
+   * Create a simulated controller
+   * @param num the number of led's to simulate
+   * @param clock the clock to advance on each update, or nullptr
+   * @param update_us how long each update takes on the simulated wire
+   */
+  explicit SimulatedController(uint32_t num, VirtualClock *clock = nullptr,
+                               uint32_t update_us = 0);
+
+  /**
+   * Begin fading to a color
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Begin crossfading to a frame
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param target the color to fade each LED to, count long
+   * @param count the number of LEDs in target
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                       uint32_t count) override;
+
+  /**
+   * Set all LEDs to a color
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetLEDs(uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Set a single LED to a color
+   * @param i the index of the LED to set (0-indexed)
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) override;
+
+  /**
+   * Set a run of LEDs to a color
+   * @param first the index of the first LED to set (0-indexed)
+   * @param count the number of LEDs to set
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetRange(uint32_t first, uint32_t count, uint8_t r, uint8_t g,
+                 uint8_t b) override;
+
+  /**
+   * Copy a run of pixels onto the LEDs
+   * @param first the index of the first LED to set (0-indexed)
+   * @param src the pixels to copy, count long
+   * @param count the number of pixels to copy
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Blit(uint32_t first, const Pixel *src, uint32_t count) override;
+
+  /**
+   * Read back a run of LEDs
+   * @param first the index of the first LED to read (0-indexed)
+   * @param dst where to copy the pixels, count long
+   * @param count the number of pixels to read
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error GetFrame(uint32_t first, Pixel *dst, uint32_t count) const override;
+
+  /**
+   * return the current pixel values
+   * @return the pixels, as they would appear after the next update
+   */
+  const std::vector<Pixel> &GetPixels() const;
+
+  /**
+   * return every frame captured so far
+   * @return the captured frames, oldest first
+   */
+  const std::vector<SimulatedFrame> &GetFrames() const;
+
+  /**
+   * Discard every frame captured so far
+   */
+  void ClearFrames();
+
+  /**
+   * Turn frame capture on or off
+   * Memory used by captured frames is not included in GetAllocationCount().
+   * @param capture true to capture frames, false to only count them
+   */
+  void SetCapture(bool capture);
+
+  /**
+   * return how many times Update() has been called
+   * @return the number of frames pushed, whether captured or not
+   */
+  uint32_t GetFrameCount() const;
+
+ protected:
+  /**
+   * capture the current pixel values as a frame
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Transmit() override;
+
+  /**
+   * Render and push one frame of the running fade
+   * @param weight the progress made across the fade in Q8 fixed point, 0 to
+   * kLerpOne
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error RenderFade(uint16_t weight) override;
+
+  /**
+   * Set and push the fade target once the fade has completed
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error EndFade() override;
+
+  /// the current pixel values
+  std::vector<Pixel> pixels_;
+
+  /// a snapshot of the pixel values at the start of the running fade
+  std::vector<Pixel> fade_from_;
+
+  /// the color that the running fade is heading towards
+  Pixel fade_to_;
+
+  /// the frame that the running crossfade is heading towards, allocated by
+  /// the first crossfade
+  std::vector<Pixel> fade_target_;
+
+  /// the clock to advance on each update, or nullptr
+  VirtualClock *clock_;
+
+  /// how long each update takes on the simulated wire
+  uint32_t update_us_;
+
+  /// true if frames should be captured
+  bool capture_ = true;
+
+  /// the number of frames pushed
+  uint32_t frame_count_ = 0;
+
+  /// the frames captured so far
+  std::vector<SimulatedFrame> frames_;
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_SIMULATED_ENABLE
+
+#endif  // LIGHTSHOW_SIMULATEDCONTROLLER_H
@@ -25,19 +25,8 @@
 
 #include "SolidColorPreset.h"
 
-#include <utility>
-
 namespace LightShow {
 
-SolidColorPreset::SolidColorPreset(std::shared_ptr<Controller> controller,
-                                   uint8_t r, uint8_t g, uint8_t b)
-    : controller_(std::move(controller)), r_(r), g_(g), b_(b) {}
-
-Error SolidColorPreset::Start() {
-  this->controller_->SetLEDs(this->r_, this->g_, this->b_);
-  this->controller_->Update();
-
-  return NoError;
-}
+template class BasicSolidColorPreset<Controller>;
 
 }  // namespace LightShow
@@ -26,28 +26,54 @@
 #ifndef LIGHTSHOW_SOLIDCOLORPRESET_H
 #define LIGHTSHOW_SOLIDCOLORPRESET_H
 
-#include <memory>
-
+#include "LightShow.h"
 #include "Preset.h"
 
+#if LIGHTSHOW_NO_HEAP != 1
+#include <memory>
+#include <utility>
+#endif
+
 namespace LightShow {
 
 /**
  * display a solid color
+ *
+ * Use the SolidColorPreset typedef to drive any Controller through its virtual
+ * interface, or name a concrete controller type as ControllerT so that its
+ * methods are called directly.
+ * @tparam ControllerT the type of the controller used to set LEDs
  */
-class SolidColorPreset : public Preset {
+template <class ControllerT>
+class BasicSolidColorPreset : public Preset {
  public:
   /**
-   * Create a current_preset that displays a solid a color
-   * @param controller
-   * @param r
-   * @param g
-   * @param b
-   * @param interval
+   * Create a preset for a controller that outlives it, such as a global
+   * @param controller the controller used to set LEDs
+   * @param r red 0-255
+   * @param g green 0-255
+   * @param b blue 0-255
+   */
+  explicit BasicSolidColorPreset(ControllerT &controller,  // NOLINT
+                                 uint8_t r = 0xFF, uint8_t g = 0xFF,
+                                 uint8_t b = 0xFF)
+      : controller_(&controller), r_(r), g_(g), b_(b) {}
+
+#if LIGHTSHOW_NO_HEAP != 1
+  /**
+   * Create a preset that keeps its controller alive
+   * @param controller the controller used to set LEDs
+   * @param r red 0-255
+   * @param g green 0-255
+   * @param b blue 0-255
    */
-  explicit SolidColorPreset(std::shared_ptr<Controller> controller,
-                            uint8_t r = 0xFF, uint8_t g = 0xFF,
-                            uint8_t b = 0xFF);
+  explicit BasicSolidColorPreset(std::shared_ptr<ControllerT> controller,
+                                 uint8_t r = 0xFF, uint8_t g = 0xFF,
+                                 uint8_t b = 0xFF)
+      : BasicSolidColorPreset(*controller, r, g, b) {
+    this->owner_ = std::move(controller);
+  }
+#endif
 
   /**
    * Perform one loop
@@ -57,7 +83,12 @@ class SolidColorPreset : public Preset {
 
  protected:
   /// controller that will be used to set LEDs
-  std::shared_ptr<Controller> controller_;
+  ControllerT *controller_;
+
+#if LIGHTSHOW_NO_HEAP != 1
+  /// keeps controller_ alive, if the preset was given shared ownership of it
+  std::shared_ptr<ControllerT> owner_;
+#endif
 
   /// red byte of the color to cycle
   uint8_t r_;
@@ -69,6 +100,21 @@ class SolidColorPreset : public Preset {
   uint8_t b_;
 };
 
+/// a solid color that drives any Controller through its virtual interface
+typedef BasicSolidColorPreset<Controller> SolidColorPreset;
+
+// the virtual version is compiled once, in SolidColorPreset.cc
+extern template class BasicSolidColorPreset<Controller>;
+
+template <class ControllerT>
+Error BasicSolidColorPreset<ControllerT>::Start() {
+  this->controller_->BeginRender();
+  this->controller_->SetLEDs(this->r_, this->g_, this->b_);
+  this->PushFrame(this->controller_);
+
+  return NoError;
+}
+
 }  // namespace LightShow
 
 #endif  // LIGHTSHOW_SOLIDCOLORPRESET_H
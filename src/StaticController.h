@@ -0,0 +1,517 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_STATICCONTROLLER_H
+#define LIGHTSHOW_STATICCONTROLLER_H
+
+#include <array>
+
+#include "Controller.h"
+#include "Pixel.h"
+
+#if LIGHTSHOW_FASTLED_ENABLE == 1
+#include "FastLED.h"
+#endif
+
+#if LIGHTSHOW_NEOPIXEL_ENABLE == 1
+#include "Adafruit_NeoPixel.h"
+#endif
+
+namespace LightShow {
+
+/**
+ * a controller whose strip length is fixed at compile time
+ *
+ * The frame, the fade snapshot and, unless LIGHTSHOW_STATIC_CROSSFADE is 0,
+ * the crossfade target are std::arrays held inside the object, so nothing is
+ * allocated on the heap.  Declared as a global, the whole
+ * controller lands in .bss, and the linker reports a sketch that does not fit
+ * in RAM instead of it failing at run time.  Loop bounds are compile-time
+ * constants, which lets the compiler unroll and vectorize them.
+ *
+ * The Backend pushes frames to the hardware.  It must provide:
+ *   Error Begin(Pixel *frame, uint32_t count);
+ *   Error Show(const Pixel *frame, uint32_t count, const OutputStage *stage,
+ *              uint8_t scale);
+ * Begin() is called before the first frame is pushed, rather than from the
+ * constructor, so that global controllers do not depend on the order in which
+ * globals are constructed.  Show() is passed the controller's output stage,
+ * or nullptr for none, which a backend that copies the frame applies as it
+ * copies, and the scale that keeps the frame within the power budget.
+ * @tparam N the number of LEDs in the strip
+ * @tparam Backend the type that pushes frames to the strip
+ */
+template <uint32_t N, class Backend>
+class StaticController final : public Controller {
+  static_assert(N > 0, "a StaticController needs at least one LED");
+
+ public:
+  /**
+   * Create a controller
+   * @param backend the object that pushes frames to the strip
+   */
+  explicit StaticController(Backend backend = Backend())
+      : backend_(backend) {
+    this->TrackPower(N);
+  }
+
+  /**
+   * Begin fading to a color
+   * This is a non-blocking operation.  Call Loop() to advance the fade.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginFade(uint32_t fade_ms, uint8_t r, uint8_t g, uint8_t b) override {
+    this->fade_from_ = this->frame_;
+    this->fade_to_.r = r;
+    this->fade_to_.g = g;
+    this->fade_to_.b = b;
+    this->StartFade(fade_ms, N * (r + g + b));
+    return NoError;
+  }
+
+#if LIGHTSHOW_STATIC_CROSSFADE == 1
+  /**
+   * Begin crossfading to a frame
+   * This is a non-blocking operation.  Call Loop() to advance the fade.  The
+   * target is held in a buffer sized at compile time, so no memory is
+   * allocated.
+   * @param fade_ms the approximate number of milliseconds over which to fade
+   * @param target the color to fade each LED to, count long
+   * @param count the number of LEDs in target
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                       uint32_t count) override {
+    return this->StartCrossFade(fade_ms, this->frame_.data(),
+                                this->fade_from_.data(),
+                                this->fade_target_.data(), N, target, count);
+  }
+#else
+  /**
+   * Refuse to crossfade, as there is no buffer for the target
+   * Build with LIGHTSHOW_STATIC_CROSSFADE set to 1 to crossfade.
+   * @param fade_ms ignored
+   * @param target ignored
+   * @param count ignored
+   * @return CrossFadeUnsupported
+   */
+  Error BeginCrossFade(uint32_t fade_ms, const Pixel *target,
+                       uint32_t count) override {
+    (void)fade_ms;
+    (void)target;
+    (void)count;
+    return CrossFadeUnsupported;
+  }
+#endif
+
+  /**
+   * Set all LEDs to a color
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetLEDs(uint8_t r, uint8_t g, uint8_t b) override {
+    for (uint32_t i = 0; i < N; i++) {
+      this->frame_[i].r = r;
+      this->frame_[i].g = g;
+      this->frame_[i].b = b;
+    }
+    this->TrackFrame(N * (r + g + b));
+    return NoError;
+  }
+
+  /**
+   * Set a single LED to a color
+   * @param i the index of the LED to set (0-indexed)
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetLED(uint32_t i, uint8_t r, uint8_t g, uint8_t b) override {
+    if (i >= N) {
+      return LEDIndexOutOfRange;
+    }
+    const Pixel &old = this->frame_[i];
+    this->TrackPixel(old.r + old.g + old.b, r + g + b);
+    this->frame_[i].r = r;
+    this->frame_[i].g = g;
+    this->frame_[i].b = b;
+    return NoError;
+  }
+
+  /**
+   * Set a run of LEDs to a color
+   * @param first the index of the first LED to set (0-indexed)
+   * @param count the number of LEDs to set
+   * @param r Red brightness, 0 to 255.
+   * @param g Green brightness, 0 to 255.
+   * @param b Blue brightness, 0 to 255.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error SetRange(uint32_t first, uint32_t count, uint8_t r, uint8_t g,
+                 uint8_t b) override {
+    return this->FillRange(this->frame_.data(), N, first, count,
+                           Pixel{r, g, b});
+  }
+
+  /**
+   * Copy a run of pixels onto the LEDs
+   * @param first the index of the first LED to set (0-indexed)
+   * @param src the pixels to copy, count long
+   * @param count the number of pixels to copy
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Blit(uint32_t first, const Pixel *src, uint32_t count) override {
+    return this->BlitRange(this->frame_.data(), N, first, src, count);
+  }
+
+  /**
+   * Read back a run of LEDs
+   * @param first the index of the first LED to read (0-indexed)
+   * @param dst where to copy the pixels, count long
+   * @param count the number of pixels to read
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error GetFrame(uint32_t first, Pixel *dst, uint32_t count) const override {
+    return ReadRange(this->frame_.data(), N, first, dst, count);
+  }
+
+  /**
+   * return the frame
+   * @return every pixel of the strip, as it will be pushed on the next update
+   */
+  std::array<Pixel, N> &GetPixels() { return this->frame_; }
+
+  /**
+   * return the backend
+   * @return the object that pushes frames to the strip
+   */
+  Backend &GetBackend() { return this->backend_; }
+
+ protected:
+  /**
+   * push the frame to the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Transmit() override {
+    if (!this->begun_) {
+      auto e = this->backend_.Begin(this->frame_.data(), N);
+      if (e != NoError) {
+        return e;
+      }
+      this->begun_ = true;
+    }
+    return this->backend_.Show(this->frame_.data(), N, this->GetOutputStage(),
+                               this->GetPowerScale());
+  }
+
+  /**
+   * Render and push one frame of the running fade
+   * @param weight the progress made across the fade in Q8 fixed point, 0 to
+   * kLerpOne
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error RenderFade(uint16_t weight) override {
+    uint8_t *frame = reinterpret_cast<uint8_t *>(this->frame_.data());
+    const uint8_t *from =
+        reinterpret_cast<const uint8_t *>(this->fade_from_.data());
+#if LIGHTSHOW_STATIC_CROSSFADE == 1
+    if (this->IsCrossFade()) {
+      LerpBuffer(frame, from,
+                 reinterpret_cast<const uint8_t *>(this->fade_target_.data()),
+                 N * sizeof(Pixel), weight);
+      return this->Update();
+    }
+#endif
+    LerpToColor(frame, from, N * sizeof(Pixel),
+                reinterpret_cast<const uint8_t *>(&this->fade_to_),
+                sizeof(Pixel), weight);
+    return this->Update();
+  }
+
+  /**
+   * Set and push the fade target once the fade has completed
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error EndFade() override { return this->RenderFade(kLerpOne); }
+
+  /// the pixels of the strip
+  std::array<Pixel, N> frame_{};
+
+  /// a snapshot of frame_ at the start of the running fade
+  std::array<Pixel, N> fade_from_{};
+
+  /// the color that the running fade is heading towards
+  Pixel fade_to_{};
+
+#if LIGHTSHOW_STATIC_CROSSFADE == 1
+  /// the frame that the running crossfade is heading towards
+  std::array<Pixel, N> fade_target_{};
+#endif
+
+  /// the object that pushes frames to the strip
+  Backend backend_;
+
+  /// true once the backend has been started
+  bool begun_ = false;
+};
+
+/**
+ * a StaticController backend that pushes frames nowhere
+ *
+ * This is useful on a host, or for a controller whose frame is read back with
+ * GetPixels() instead of being shown.
+ */
+class NullBackend {
+ public:
+  /**
+   * Start the backend
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Begin(Pixel *frame, uint32_t count) {
+    (void)frame;
+    (void)count;
+    return NoError;
+  }
+
+  /**
+   * Push a frame
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @param stage the corrections to apply, or nullptr for none
+   * @param scale the power limit scale, 255 for none
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Show(const Pixel *frame, uint32_t count, const OutputStage *stage,
+             uint8_t scale) {
+    (void)frame;
+    (void)count;
+    (void)stage;
+    (void)scale;
+    return NoError;
+  }
+};
+
+#if LIGHTSHOW_FASTLED_ENABLE == 1
+
+/**
+ * a StaticController backend for a FastLED NeoPixel strip
+ *
+ * FastLED reads the controller's frame directly, as Pixel has the same layout
+ * as CRGB, so no pixels are copied.  With an output stage, the corrected frame
+ * is written to a transmit copy, allocated on the first push that needs it,
+ * and FastLED reads that instead.  A no-heap build has no transmit copy, so
+ * only the stage's brightness is applied, by FastLED, and Show() returns
+ * OutputStageUnsupported.
+ * FastLED applies the power limit as it encodes the frame.  Each pin may only
+ * be used by one strip.
+ * @tparam PIN the pin that drives the strip
+ */
+template <uint8_t PIN>
+class FastLEDBackend {
+  static_assert(sizeof(Pixel) == sizeof(CRGB), "Pixel must match CRGB");
+
+ public:
+  FastLEDBackend() = default;
+
+#if LIGHTSHOW_NO_HEAP != 1
+  /**
+   * Copy a backend, leaving the copy to make its own transmit copy
+   * @param other the backend to copy
+   */
+  FastLEDBackend(const FastLEDBackend &other)
+      : controller_(other.controller_) {}
+
+  /**
+   * Copy a backend, leaving this one to make its own transmit copy
+   * @param other the backend to copy
+   * @return this backend
+   */
+  FastLEDBackend &operator=(const FastLEDBackend &other) {
+    if (this != &other) {
+      this->controller_ = other.controller_;
+      delete[] this->out_;
+      this->out_ = nullptr;
+    }
+    return *this;
+  }
+
+  /**
+   * Free the transmit copy
+   */
+  ~FastLEDBackend() { delete[] this->out_; }
+#endif
+
+  /**
+   * Register the strip with FastLED
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Begin(Pixel *frame, uint32_t count) {
+    this->controller_ = &FastLED.addLeds<NEOPIXEL, PIN>(
+        reinterpret_cast<CRGB *>(frame), static_cast<int>(count));
+    return NoError;
+  }
+
+  /**
+   * Push a frame
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @param stage the corrections to apply, or nullptr for none
+   * @param scale the power limit scale, 255 for none
+   * @return 0 on success, or OutputStageUnsupported if a no-heap build was
+   * given a stage
+   */
+  Error Show(const Pixel *frame, uint32_t count, const OutputStage *stage,
+             uint8_t scale) {
+    Error result = NoError;
+    const Pixel *wire = frame;
+    if (stage != nullptr) {
+#if LIGHTSHOW_NO_HEAP != 1
+      if (this->out_ == nullptr) {
+        this->out_ = new Pixel[count];
+      }
+      stage->Apply(frame, this->out_, count);
+      wire = this->out_;
+#else
+      // FastLED can still apply the stage's brightness, which keeps the strip
+      // within any power budget
+      scale = Scale8(scale, stage->GetBrightness());
+      result = OutputStageUnsupported;
+#endif
+    }
+    // FastLED only reads the buffer, but takes it as writable
+    CRGB *leds = reinterpret_cast<CRGB *>(const_cast<Pixel *>(wire));
+    if (this->controller_->leds() != leds) {
+      this->controller_->setLeds(leds, static_cast<int>(count));
+    }
+    // FastLED scales by the power limit as it encodes the frame for the wire
+    this->controller_->showLeds(scale);
+    return result;
+  }
+
+ private:
+  /// the FastLED controller for the strip, owned by FastLED
+  CLEDController *controller_ = nullptr;
+
+#if LIGHTSHOW_NO_HEAP != 1
+  /// the corrected frame sent to the strip, or nullptr until a stage is used
+  Pixel *out_ = nullptr;
+#endif
+};
+
+#endif  // LIGHTSHOW_FASTLED_ENABLE
+
+#if LIGHTSHOW_NEOPIXEL_ENABLE == 1
+
+/**
+ * a StaticController backend for an Adafruit NeoPixel strip
+ *
+ * Note that the Adafruit library allocates its own pixel buffer on the heap,
+ * which is outside of LightShow's control.
+ */
+class NeoPixelBackend {
+ public:
+  /**
+   * Create a backend
+   * @param pin Arduino pin number which will drive the NeoPixel data in.
+   * @param type Pixel type -- add together NEO_* constants defined in
+   *          Adafruit_NeoPixel.h
+   */
+  explicit NeoPixelBackend(int16_t pin = 6,
+                           neoPixelType type = NEO_GRB + NEO_KHZ800)
+      : pin_(pin), type_(type) {}
+
+  /**
+   * Start the strip
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Begin(Pixel *frame, uint32_t count) {
+    (void)frame;
+    this->neopixel_.updateType(this->type_);
+    this->neopixel_.updateLength(static_cast<uint16_t>(count));
+    this->neopixel_.setPin(this->pin_);
+    this->neopixel_.begin();
+    return NoError;
+  }
+
+  /**
+   * Copy a frame into the NeoPixel buffer and push it
+   * The output stage and power limit are applied as each pixel is copied.
+   * @param frame the pixels of the strip
+   * @param count the number of pixels in the strip
+   * @param stage the corrections to apply, or nullptr for none
+   * @param scale the power limit scale, 255 for none
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Show(const Pixel *frame, uint32_t count, const OutputStage *stage,
+             uint8_t scale) {
+    if (stage == nullptr && scale == 0xFF) {
+      for (uint32_t i = 0; i < count; i++) {
+        this->neopixel_.setPixelColor(i, frame[i].r, frame[i].g, frame[i].b);
+      }
+    } else {
+      for (uint32_t i = 0; i < count; i++) {
+        auto p = frame[i];
+        if (stage != nullptr) {
+          p.r = stage->GetTable(0)[p.r];
+          p.g = stage->GetTable(1)[p.g];
+          p.b = stage->GetTable(2)[p.b];
+        }
+        this->neopixel_.setPixelColor(i, Scale8(p.r, scale),
+                                      Scale8(p.g, scale), Scale8(p.b, scale));
+      }
+    }
+    this->neopixel_.show();
+    return NoError;
+  }
+
+ private:
+  /// the pin that drives the strip
+  int16_t pin_;
+
+  /// the NEO_* color order and speed of the strip
+  neoPixelType type_;
+
+  /// the NeoPixel strip, sized when the backend is started
+  Adafruit_NeoPixel neopixel_;
+};
+
+#endif  // LIGHTSHOW_NEOPIXEL_ENABLE
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_STATICCONTROLLER_H
@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "Stats.h"
+
+#if LIGHTSHOW_STATS_ENABLE == 1
+
+namespace LightShow {
+
+uint32_t FrameStats::GetFramesPerSecond() const {
+  if (this->average_frame_us == 0) {
+    return 0;
+  }
+  return (1000000UL + this->average_frame_us / 2) / this->average_frame_us;
+}
+
+void FrameStats::PrintTo(Print &out) const {  // NOLINT(runtime/references)
+  out.print("frames: ");
+  out.println(this->frames);
+  out.print("fps: ");
+  out.println(this->GetFramesPerSecond());
+  out.print("render us: ");
+  out.print(this->render_us);
+  out.print(" (max ");
+  out.print(this->max_render_us);
+  out.println(")");
+  out.print("transmit us: ");
+  out.print(this->transmit_us);
+  out.print(" (max ");
+  out.print(this->max_transmit_us);
+  out.println(")");
+  out.print("jitter us:");
+  for (uint8_t i = 0; i < kJitterBuckets; i++) {
+    out.print(i + 1 < kJitterBuckets ? " <" : " >=");
+    out.print(kJitterBucketUs << (i + 1 < kJitterBuckets ? i : i - 1));
+    out.print(":");
+    out.print(this->jitter[i]);
+  }
+  out.println();
+}
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_STATS_ENABLE
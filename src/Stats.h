@@ -0,0 +1,98 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_STATS_H
+#define LIGHTSHOW_STATS_H
+
+#include <Arduino.h>
+
+#include "LightShow.h"
+
+#if LIGHTSHOW_STATS_ENABLE == 1
+
+namespace LightShow {
+
+/// the number of buckets in the frame jitter histogram
+constexpr uint8_t kJitterBuckets = 8;
+
+/// the upper bound of the first jitter bucket, in microseconds
+constexpr uint32_t kJitterBucketUs = 64;
+
+/**
+ * timing of the frames pushed by a controller
+ *
+ * Times are in microseconds.  Render time runs from the start of a preset's
+ * Loop(), or of a fade frame, to the following Update().  Transmit time is
+ * the time spent pushing the frame to the strip.
+ */
+struct FrameStats {
+  /// the number of frames pushed
+  uint32_t frames;
+
+  /// the render time of the last frame
+  uint32_t render_us;
+
+  /// the longest render time seen
+  uint32_t max_render_us;
+
+  /// the transmit time of the last frame
+  uint32_t transmit_us;
+
+  /// the longest transmit time seen
+  uint32_t max_transmit_us;
+
+  /// the time between the last two frames
+  uint32_t frame_us;
+
+  /// a running average of the time between frames
+  uint32_t average_frame_us;
+
+  /**
+   * how far each frame interval strayed from the running average
+   *
+   * Bucket n counts intervals that were within kJitterBucketUs << n of the
+   * average, and not within any smaller bucket.  The last bucket counts every
+   * larger difference.
+   */
+  uint32_t jitter[kJitterBuckets];
+
+  /**
+   * return the achieved frame rate
+   * @return the frames per second, based on the running average interval
+   */
+  uint32_t GetFramesPerSecond() const;
+
+  /**
+   * Print the statistics in human-readable form
+   * @param out where to print, for example Serial
+   */
+  void PrintTo(Print &out) const;  // NOLINT(runtime/references)
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_STATS_ENABLE
+
+#endif  // LIGHTSHOW_STATS_H
@@ -0,0 +1,240 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "StreamPreset.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <utility>
+
+#include "Controller.h"
+
+namespace LightShow {
+
+namespace {
+
+/// the bytes that start an Adalight frame
+const uint8_t kAdalightMagic[] = {'A', 'd', 'a'};
+
+/// the byte that starts a TPM2 packet
+const uint8_t kTPM2Magic[] = {0xC9};
+
+/// the TPM2 packet type that carries a frame
+constexpr uint8_t kTPM2Data = 0xDA;
+
+/// the byte that ends a TPM2 packet
+constexpr uint8_t kTPM2End = 0x36;
+
+/// the channels of each ColorOrder, by their offset within a Pixel
+const uint8_t kChannels[][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2},
+                                {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+
+}  // namespace
+
+StreamPreset::StreamPreset(std::shared_ptr<Controller> controller,
+                           Stream *stream, uint32_t num,
+                           StreamProtocol protocol, ColorOrder order)
+    : controller_(std::move(controller)),
+      stream_(stream),
+      num_(num),
+      protocol_(protocol),
+      in_order_(order == ColorOrder::RGB) {
+  for (uint8_t k = 0; k < 3; k++) {
+    this->channel_[k] = kChannels[static_cast<uint8_t>(order)][k];
+  }
+}
+
+Error StreamPreset::Start() {
+  this->state_ = State::Magic;
+  this->header_len_ = 0;
+  this->window_start_ms_ = millis();
+  this->window_frames_ = 0;
+  return NoError;
+}
+
+Error StreamPreset::Loop() {
+  this->controller_->BeginRender();
+
+  const uint32_t now = millis();
+  if (now - this->window_start_ms_ >= 1000) {
+    this->fps_ = this->window_frames_ * 1000 / (now - this->window_start_ms_);
+    this->window_start_ms_ = now;
+    this->window_frames_ = 0;
+  }
+
+  // only read what has already arrived, so that loop() never waits
+  int available = this->stream_->available();
+  while (available > 0) {
+    if (this->state_ == State::Payload) {
+      const uint32_t n = this->ReadPayload(static_cast<uint32_t>(available));
+      if (n == 0) {
+        break;
+      }
+      available -= static_cast<int>(n);
+      if (this->payload_left_ == 0) {
+        if (this->protocol_ == StreamProtocol::Adalight) {
+          this->state_ = State::Magic;
+          return this->Show();
+        }
+        this->state_ = State::Trailer;
+      }
+      continue;
+    }
+
+    const int c = this->stream_->read();
+    if (c < 0) {
+      break;
+    }
+    --available;
+    if (this->state_ != State::Trailer) {
+      this->ParseHeader(static_cast<uint8_t>(c));
+      continue;
+    }
+
+    this->state_ = State::Magic;
+    if (c != kTPM2End) {
+      this->Drop();
+    } else if (this->header_[0] == kTPM2Data) {
+      return this->Show();
+    }
+  }
+  return NoError;
+}
+
+uint32_t StreamPreset::GetFrameCount() const { return this->frames_; }
+
+uint32_t StreamPreset::GetDroppedFrames() const { return this->dropped_; }
+
+uint32_t StreamPreset::GetFramesPerSecond() const { return this->fps_; }
+
+void StreamPreset::ParseHeader(uint8_t c) {
+  const bool adalight = this->protocol_ == StreamProtocol::Adalight;
+  if (this->state_ == State::Magic) {
+    const uint8_t *magic = adalight ? kAdalightMagic : kTPM2Magic;
+    const uint8_t magic_len =
+        adalight ? sizeof(kAdalightMagic) : sizeof(kTPM2Magic);
+    if (c != magic[this->header_len_]) {
+      this->header_len_ = (c == magic[0]) ? 1 : 0;
+      return;
+    }
+    if (++this->header_len_ == magic_len) {
+      this->state_ = State::Header;
+      this->header_len_ = 0;
+    }
+    return;
+  }
+
+  this->header_[this->header_len_++] = c;
+  if (this->header_len_ < 3) {
+    return;
+  }
+  this->header_len_ = 0;
+  this->payload_pos_ = 0;
+  if (adalight) {
+    if ((this->header_[0] ^ this->header_[1] ^ 0x55) != this->header_[2]) {
+      this->Drop();
+      return;
+    }
+    const uint32_t count =
+        (static_cast<uint32_t>(this->header_[0]) << 8 | this->header_[1]) + 1;
+    this->payload_left_ = count * sizeof(Pixel);
+    this->state_ = State::Payload;
+    return;
+  }
+
+  this->payload_left_ =
+      static_cast<uint32_t>(this->header_[1]) << 8 | this->header_[2];
+  if (this->header_[0] != kTPM2Data) {
+    // skip packets that do not carry a frame, by reading them into a run that
+    // starts past its end
+    const uint32_t runs = (this->num_ + kChunkPixels - 1) / kChunkPixels;
+    this->payload_pos_ = runs * kChunkPixels * sizeof(Pixel);
+  }
+  this->state_ = (this->payload_left_ > 0) ? State::Payload : State::Trailer;
+}
+
+uint32_t StreamPreset::ReadPayload(uint32_t available) {
+  const uint32_t n = (available < this->payload_left_) ? available
+                                                       : this->payload_left_;
+  const uint32_t chunk_bytes = kChunkPixels * sizeof(Pixel);
+  uint8_t *bytes = reinterpret_cast<uint8_t *>(this->chunk_);
+  uint32_t done = 0;
+  while (done < n) {
+    const uint32_t offset = this->payload_pos_ % chunk_bytes;
+    uint32_t take = n - done;
+    if (take > chunk_bytes - offset) {
+      take = chunk_bytes - offset;
+    }
+    take = this->stream_->readBytes(bytes + offset, take);
+    if (take == 0) {
+      break;
+    }
+    done += take;
+    this->payload_pos_ += take;
+
+    // put each pixel that this read completed into the frame's color order
+    const uint32_t filled = offset + take;
+    if (!this->in_order_) {
+      for (uint32_t i = offset / 3; i < filled / 3; i++) {
+        uint8_t *pixel = bytes + i * sizeof(Pixel);
+        const uint8_t sent[3] = {pixel[0], pixel[1], pixel[2]};
+        for (uint8_t k = 0; k < 3; k++) {
+          pixel[this->channel_[k]] = sent[k];
+        }
+      }
+    }
+
+    // hand the run over once it is full or the payload is complete; pixels
+    // past the end of the strip are not blitted
+    if (filled == chunk_bytes || done == this->payload_left_) {
+      const uint32_t first = (this->payload_pos_ - filled) / sizeof(Pixel);
+      if (first < this->num_) {
+        uint32_t count = filled / sizeof(Pixel);
+        if (count > this->num_ - first) {
+          count = this->num_ - first;
+        }
+        this->controller_->Blit(first, this->chunk_, count);
+      }
+    }
+  }
+  this->payload_left_ -= done;
+  return done;
+}
+
+void StreamPreset::Drop() {
+  ++this->dropped_;
+  this->state_ = State::Magic;
+  this->header_len_ = 0;
+}
+
+Error StreamPreset::Show() {
+  ++this->frames_;
+  ++this->window_frames_;
+  return this->PushFrame(this->controller_.get());
+}
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
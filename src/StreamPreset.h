@@ -0,0 +1,201 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_PRESET_STREAM_H
+#define LIGHTSHOW_PRESET_STREAM_H
+
+#include "LightShow.h"
+
+#if LIGHTSHOW_NO_HEAP != 1
+
+#include <Arduino.h>
+
+#include <memory>
+
+#include "Pixel.h"
+#include "Preset.h"
+
+namespace LightShow {
+
+/**
+ * the framing of pixels sent over a byte stream
+ */
+enum class StreamProtocol : uint8_t {
+  /// "Ada", count - 1 (big-endian), a checksum, then count pixels
+  Adalight,
+  /// 0xC9 0xDA, the payload length (big-endian), the payload, then 0x36
+  TPM2
+};
+
+/**
+ * show frames sent from a PC over a serial port or any other Stream
+ *
+ * Frames are parsed as the bytes arrive, so loop() never waits for a whole
+ * frame.  Payload bytes are gathered a few pixels at a time, remapped from
+ * the sender's color order, and blitted straight into the controller's frame,
+ * so the preset holds no frame of its own.  A frame is pushed as soon as its
+ * last byte has arrived, and reading stops there until the next loop(), so a
+ * pushed frame is never mixed with the next one.  As the controller's frame
+ * fills while a frame arrives, run this preset on its own rather than under a
+ * Scheduler, which would push partly received frames.
+ *
+ * Frames that fail their checksum or end marker are dropped, as are frames
+ * lost to a serial buffer overflow, which show up as broken framing.  The
+ * pixels of a dropped frame that had already arrived stay in the controller's
+ * frame until the next frame overwrites them, but are not pushed.
+ */
+class StreamPreset : public Preset {
+ public:
+  /**
+   * Create a preset that shows frames from a stream
+   * @param controller the controller used to set LEDs
+   * @param stream the stream to read from, which must outlive the preset
+   * @param num the number of pixels to show; extra pixels are ignored
+   * @param protocol the framing that the sender uses
+   * @param order the order in which the sender sends each pixel's channels
+   */
+  StreamPreset(std::shared_ptr<Controller> controller, Stream *stream,
+               uint32_t num, StreamProtocol protocol = StreamProtocol::Adalight,
+               ColorOrder order = ColorOrder::RGB);
+
+  /**
+   * Start waiting for the next frame
+   * Any partly received frame is discarded.
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Start() override;
+
+  /**
+   * Read whatever bytes have arrived, and push the frame once it is complete
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Loop() override;
+
+  /**
+   * return how many frames have been shown
+   * @return the number of frames
+   */
+  uint32_t GetFrameCount() const;
+
+  /**
+   * return how many frames were dropped as corrupt
+   * @return the number of frames
+   */
+  uint32_t GetDroppedFrames() const;
+
+  /**
+   * return the rate at which frames were shown over the last second or so
+   * @return frames per second
+   */
+  uint32_t GetFramesPerSecond() const;
+
+ protected:
+  /// the number of pixels gathered before they are blitted to the controller
+  static constexpr uint8_t kChunkPixels = 21;
+
+  /// where the parser is within a frame
+  enum class State : uint8_t { Magic, Header, Payload, Trailer };
+
+  /**
+   * Parse one header byte
+   * @param c the byte
+   */
+  void ParseHeader(uint8_t c);
+
+  /**
+   * Read payload bytes into the controller's frame
+   * @param available the number of bytes waiting in the stream
+   * @return the number of bytes read
+   */
+  uint32_t ReadPayload(uint32_t available);
+
+  /**
+   * Count a frame as dropped, and look for the next one
+   */
+  void Drop();
+
+  /**
+   * Count the frame, which is already in the controller's frame, and push it
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Show();
+
+  /// controller that will be used to set LEDs
+  std::shared_ptr<Controller> controller_;
+
+  /// the stream to read from
+  Stream *stream_;
+
+  /// the number of pixels to show
+  uint32_t num_;
+
+  /// the framing that the sender uses
+  StreamProtocol protocol_;
+
+  /// the offset within a Pixel of each channel, in the order they are sent
+  uint8_t channel_[3];
+
+  /// true if channels are sent in the same order as Pixel holds them
+  bool in_order_;
+
+  /// where the parser is within a frame
+  State state_ = State::Magic;
+
+  /// the header bytes received so far
+  uint8_t header_[4];
+
+  /// the number of header or magic bytes received so far
+  uint8_t header_len_ = 0;
+
+  /// the number of payload bytes still to come
+  uint32_t payload_left_ = 0;
+
+  /// the offset within the frame of the next payload byte
+  uint32_t payload_pos_ = 0;
+
+  /// the run of pixels being received, not yet blitted to the controller
+  Pixel chunk_[kChunkPixels];
+
+  /// the number of frames shown
+  uint32_t frames_ = 0;
+
+  /// the number of frames dropped
+  uint32_t dropped_ = 0;
+
+  /// the millis() time at which the current rate window started
+  uint32_t window_start_ms_ = 0;
+
+  /// the number of frames shown in the current rate window
+  uint32_t window_frames_ = 0;
+
+  /// the rate measured over the last complete window
+  uint32_t fps_ = 0;
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_NO_HEAP
+
+#endif  // LIGHTSHOW_PRESET_STREAM_H
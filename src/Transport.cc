@@ -0,0 +1,143 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "Transport.h"
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+#include <chrono>
+#endif
+
+namespace LightShow {
+
+void Transport::SetCompletionCallback(TransportCallback callback,
+                                      void *context) {
+  this->callback_ = callback;
+  this->context_ = context;
+}
+
+void Transport::Complete() {
+  if (this->callback_ != nullptr) {
+    this->callback_(this, this->context_);
+  }
+}
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+
+ThreadTransport::ThreadTransport(uint32_t pixel_ns, bool async)
+    : pixel_ns_(pixel_ns), async_(async) {}
+
+ThreadTransport::~ThreadTransport() {
+  if (!this->worker_.joinable()) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->changed_.wait(lock, [this] { return !this->busy_; });
+    this->stop_ = true;
+  }
+  this->changed_.notify_all();
+  this->worker_.join();
+}
+
+Error ThreadTransport::Begin(Pixel *frame, uint32_t count) {
+  (void)frame;
+  if (!this->worker_.joinable()) {
+    this->worker_ = std::thread(&ThreadTransport::Run, this);
+  }
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->sent_.assign(count, Pixel());
+  return NoError;
+}
+
+Error ThreadTransport::Send(const Pixel *frame, uint32_t count) {
+  {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->changed_.wait(lock, [this] { return !this->busy_; });
+    this->frame_ = frame;
+    this->count_ = count;
+    this->busy_ = true;
+  }
+  this->changed_.notify_all();
+  if (!this->async_) {
+    this->Wait();
+  }
+  return NoError;
+}
+
+bool ThreadTransport::IsBusy() const {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->busy_;
+}
+
+void ThreadTransport::Wait() {
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  this->changed_.wait(lock, [this] { return !this->busy_; });
+}
+
+uint32_t ThreadTransport::GetSentCount() const { return this->sent_count_; }
+
+std::vector<Pixel> ThreadTransport::GetSentFrame() const {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->sent_;
+}
+
+void ThreadTransport::Run() {
+  using Clock = std::chrono::steady_clock;
+  for (;;) {
+    const Pixel *frame;
+    uint32_t count;
+    {
+      std::unique_lock<std::mutex> lock(this->mutex_);
+      this->changed_.wait(lock,
+                          [this] { return this->stop_ || this->busy_; });
+      if (this->stop_) {
+        return;
+      }
+      frame = this->frame_;
+      count = this->count_;
+    }
+
+    // sleep rather than spin, leaving the CPU to the renderer as DMA would
+    std::this_thread::sleep_until(
+        Clock::now() + std::chrono::nanoseconds(
+                           static_cast<uint64_t>(this->pixel_ns_) * count));
+
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->sent_.assign(frame, frame + count);
+    }
+    ++this->sent_count_;
+    this->Complete();
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->busy_ = false;
+    }
+    this->changed_.notify_all();
+  }
+}
+
+#endif  // LIGHTSHOW_SIMULATED_ENABLE
+
+}  // namespace LightShow
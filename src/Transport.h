@@ -0,0 +1,269 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_TRANSPORT_H
+#define LIGHTSHOW_TRANSPORT_H
+
+#include "Error.h"
+#include "LightShow.h"
+#include "Pixel.h"
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+namespace LightShow {
+
+class Transport;
+
+/**
+ * a function to call when a transport has finished sending a frame
+ * This may be called from an interrupt or from another thread, so keep it
+ * short.
+ */
+typedef void (*TransportCallback)(Transport *transport, void *context);
+
+/**
+ * the link that carries frames to a strip
+ *
+ * A transport may send a frame in the background, for example through DMA,
+ * RMT or I2S, and return from Send() straight away.  The frame passed to
+ * Send() must then be left alone until the transport is no longer busy.
+ */
+class Transport {
+ public:
+  virtual ~Transport() = default;
+
+  /**
+   * Start the transport
+   * @param frame the buffer that frames will be sent from
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  virtual Error Begin(Pixel *frame, uint32_t count) = 0;
+
+  /**
+   * Start sending a frame
+   * @param frame the pixels to send
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  virtual Error Send(const Pixel *frame, uint32_t count) = 0;
+
+  /**
+   * check whether a frame is still being sent
+   * @return true if the last frame has not finished sending, else false
+   */
+  virtual bool IsBusy() const { return false; }
+
+  /**
+   * Block until the last frame has finished sending
+   */
+  virtual void Wait() {}
+
+  /**
+   * Set a function to call each time a frame has been sent
+   * @param callback the function to call, or nullptr for none
+   * @param context passed to the callback
+   */
+  void SetCompletionCallback(TransportCallback callback, void *context);
+
+ protected:
+  /**
+   * Report that a frame has been sent
+   */
+  void Complete();
+
+  /// the function to call when a frame has been sent
+  TransportCallback callback_ = nullptr;
+
+  /// passed to callback_
+  void *context_ = nullptr;
+};
+
+/**
+ * a transport that sends each frame through a StaticController backend
+ *
+ * The backends in this library push a frame before returning, so Send()
+ * blocks and the transport is never busy afterwards.  This is the only
+ * transport for a board so far: sending in the background needs a transport
+ * written for the platform's DMA, RMT or I2S peripheral.
+ * @tparam Backend the type that pushes frames to the strip
+ */
+template <class Backend>
+class BackendTransport : public Transport {
+ public:
+  /**
+   * Create a transport
+   * @param backend the object that pushes frames to the strip
+   */
+  explicit BackendTransport(Backend backend = Backend()) : backend_(backend) {}
+
+  /**
+   * Start the backend
+   * @param frame the buffer that frames will be sent from
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Begin(Pixel *frame, uint32_t count) override {
+    return this->backend_.Begin(frame, count);
+  }
+
+  /**
+   * Push a frame
+   * @param frame the pixels to send, already corrected and scaled by the
+   * controller
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Send(const Pixel *frame, uint32_t count) override {
+    auto e = this->backend_.Show(frame, count, nullptr, 0xFF);
+    this->Complete();
+    return e;
+  }
+
+ protected:
+  /// the object that pushes frames to the strip
+  Backend backend_;
+};
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+
+/**
+ * a transport that sends frames from a second thread, on a host
+ *
+ * This stands in for DMA hardware.  Each frame occupies the worker thread for
+ * as long as the wire would, sleeping so that rendering can go on even on a
+ * single core.  The frame is copied out of the buffer as the send finishes, so
+ * a frame that was changed while it was being sent shows up as a torn frame in
+ * GetSentFrame().
+ */
+class ThreadTransport : public Transport {
+ public:
+  /**
+   * Create a transport
+   * @param pixel_ns how long each pixel takes on the wire, in nanoseconds;
+   * 30000 for a WS2812 strip
+   * @param async true to return from Send() straight away, false to block
+   * until the frame has been sent, for comparison
+   */
+  explicit ThreadTransport(uint32_t pixel_ns = 30000, bool async = true);
+
+  /**
+   * Stop the worker thread, once the last frame has been sent
+   */
+  ~ThreadTransport();
+
+  /**
+   * Start the worker thread
+   * @param frame the buffer that frames will be sent from
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Begin(Pixel *frame, uint32_t count) override;
+
+  /**
+   * Start sending a frame, waiting for the last one first
+   * @param frame the pixels to send
+   * @param count the number of pixels in the strip
+   * @return 0 on success or a LightShow::Error on error
+   */
+  Error Send(const Pixel *frame, uint32_t count) override;
+
+  /**
+   * check whether a frame is still being sent
+   * @return true if the last frame has not finished sending, else false
+   */
+  bool IsBusy() const override;
+
+  /**
+   * Block until the last frame has finished sending
+   */
+  void Wait() override;
+
+  /**
+   * return how many frames have been sent
+   * @return the number of frames
+   */
+  uint32_t GetSentCount() const;
+
+  /**
+   * return the last frame sent
+   * @return a copy of every pixel of the frame
+   */
+  std::vector<Pixel> GetSentFrame() const;
+
+ private:
+  ThreadTransport(const ThreadTransport &) = delete;
+  ThreadTransport &operator=(const ThreadTransport &) = delete;
+
+  /**
+   * Send frames as they are handed over, until stopped
+   */
+  void Run();
+
+  /// how long each pixel takes on the wire
+  uint32_t pixel_ns_;
+
+  /// true if Send() returns straight away
+  bool async_;
+
+  /// guards every member below
+  mutable std::mutex mutex_;
+
+  /// signalled when a frame is handed over, sent, or the thread must stop
+  std::condition_variable changed_;
+
+  /// the frame being sent, or nullptr
+  const Pixel *frame_ = nullptr;
+
+  /// the number of pixels in frame_
+  uint32_t count_ = 0;
+
+  /// true from Send() until the frame has been sent
+  bool busy_ = false;
+
+  /// true when the worker thread must stop
+  bool stop_ = false;
+
+  /// the last frame sent
+  std::vector<Pixel> sent_;
+
+  /// the number of frames sent
+  std::atomic<uint32_t> sent_count_{0};
+
+  /// sends frames in the background
+  std::thread worker_;
+};
+
+#endif  // LIGHTSHOW_SIMULATED_ENABLE
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_TRANSPORT_H
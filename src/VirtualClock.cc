@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#include "VirtualClock.h"
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+
+namespace LightShow {
+
+namespace {
+
+/// the clock that drives millis() and micros(), if any
+VirtualClock *installed_clock = nullptr;
+
+}  // namespace
+
+VirtualClock::VirtualClock(uint64_t start_us, uint32_t step_us)
+    : now_us_(start_us), step_us_(step_us) {}
+
+uint32_t VirtualClock::Micros() {
+  const auto now = this->now_us_;
+  this->now_us_ += this->step_us_;
+  return static_cast<uint32_t>(now);
+}
+
+uint32_t VirtualClock::Millis() {
+  const auto now = this->now_us_;
+  this->now_us_ += this->step_us_;
+  return static_cast<uint32_t>(now / 1000);
+}
+
+uint64_t VirtualClock::Now() const { return this->now_us_; }
+
+void VirtualClock::Advance(uint32_t us) { this->now_us_ += us; }
+
+void VirtualClock::SetStep(uint32_t step_us) { this->step_us_ = step_us; }
+
+void VirtualClock::Install(VirtualClock *clock) { installed_clock = clock; }
+
+VirtualClock *VirtualClock::Installed() { return installed_clock; }
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_SIMULATED_ENABLE
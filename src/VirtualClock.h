@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2022 Cameron King
+//
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sublicense, and/or sell copies of the Software,
+// and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+// BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+/// @file
+
+#ifndef LIGHTSHOW_VIRTUALCLOCK_H
+#define LIGHTSHOW_VIRTUALCLOCK_H
+
+#include "LightShow.h"
+
+#if LIGHTSHOW_SIMULATED_ENABLE == 1
+
+#include <stdint.h>
+
+namespace LightShow {
+
+/**
+ * a clock that only moves when told to
+ *
+ * The host shim in extras/host implements millis() and micros() on top of the
+ * installed VirtualClock, so code that waits on time runs as fast as the host
+ * allows and produces the same output on every run.
+ */
+class VirtualClock {
+ public:
+  /**
+   * Create a virtual clock
+   * @param start_us the initial time, in microseconds
+   * @param step_us how far the clock moves each time it is read, so that
+   * code which busy-waits on millis() eventually finishes
+   */
+  explicit VirtualClock(uint64_t start_us = 0, uint32_t step_us = 0);
+
+  /**
+   * Read the time in microseconds, then advance the clock by the step
+   * @return the time in microseconds, wrapping like micros()
+   */
+  uint32_t Micros();
+
+  /**
+   * Read the time in milliseconds, then advance the clock by the step
+   * @return the time in milliseconds, wrapping like millis()
+   */
+  uint32_t Millis();
+
+  /**
+   * Read the time without advancing the clock
+   * @return the time in microseconds since the clock started
+   */
+  uint64_t Now() const;
+
+  /**
+   * Move the clock forward
+   * @param us the number of microseconds to advance
+   */
+  void Advance(uint32_t us);
+
+  /**
+   * Set how far the clock moves each time it is read
+   * @param step_us the number of microseconds to advance per read
+   */
+  void SetStep(uint32_t step_us);
+
+  /**
+   * Make a clock the source of millis() and micros()
+   * @param clock the clock to install, or nullptr to use real time
+   */
+  static void Install(VirtualClock *clock);
+
+  /**
+   * return the clock that drives millis() and micros()
+   * @return the installed clock, or nullptr if real time is used
+   */
+  static VirtualClock *Installed();
+
+ protected:
+  /// the current time in microseconds
+  uint64_t now_us_;
+
+  /// how far the clock moves each time it is read
+  uint32_t step_us_;
+};
+
+}  // namespace LightShow
+
+#endif  // LIGHTSHOW_SIMULATED_ENABLE
+
+#endif  // LIGHTSHOW_VIRTUALCLOCK_H